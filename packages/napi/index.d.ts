@@ -1 +1,33 @@
 export function test(): void
+export function backend(): {
+    simd: 'avx512' | 'avx2' | 'scalar'
+    threads: number
+    cuda: boolean
+}
+
+/**
+ * fields and coefficients are indexed by grid node i + nx * (j + ny * k), like `tool.conformal` of @ttk/occ.
+ * `ex` is the integral along the edge from xs[i] to xs[i + 1], `hx` the one along the dual edge through the face at xs[i]
+ */
+export type FdtdFields = Record<'ex' | 'ey' | 'ez' | 'hx' | 'hy' | 'hz', Float32Array>
+/**
+ * `a` scales the previous value (1 when omitted) and `b` the curl
+ */
+export type FdtdCoefs = Record<'bx' | 'by' | 'bz', Float32Array> & Partial<Record<'ax' | 'ay' | 'az', Float32Array>>
+export interface FdtdOptions {
+    /**
+     * defaults to the hardware concurrency
+     */
+    threads?: number
+}
+
+export const fdtd: {
+    /**
+     * h = a * h - b * curl(e), fields beyond the grid are taken as zero
+     */
+    updateH(dims: [number, number, number], fields: FdtdFields, coefs: FdtdCoefs, opts?: FdtdOptions): void
+    /**
+     * e = a * e + b * curl(h)
+     */
+    updateE(dims: [number, number, number], fields: FdtdFields, coefs: FdtdCoefs, opts?: FdtdOptions): void
+}
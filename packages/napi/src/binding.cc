@@ -0,0 +1,105 @@
+#include <napi.h>
+#include <string>
+#include <thread>
+
+#include "fdtd.h"
+
+Napi::Value Test(const Napi::CallbackInfo &info) {
+    return info.Env().Undefined();
+}
+
+Napi::Value Backend(const Napi::CallbackInfo &info) {
+    auto ret = Napi::Object::New(info.Env());
+    ret.Set("simd", FdtdSimd());
+    ret.Set("threads", std::thread::hardware_concurrency());
+#ifdef USE_CUDA
+    ret.Set("cuda", true);
+#else
+    ret.Set("cuda", false);
+#endif
+    return ret;
+}
+
+float *GetFdtdArray(Napi::Object obj, const char *key, size_t count, bool optional, std::string &err) {
+    auto val = obj.Get(key);
+    if (optional && val.IsUndefined()) {
+        return nullptr;
+    }
+    if (!val.IsTypedArray() || val.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        err = std::string(key) + " should be a Float32Array";
+        return nullptr;
+    }
+    auto arr = val.As<Napi::Float32Array>();
+    if (arr.ElementLength() != count) {
+        err = std::string(key) + " should have " + std::to_string(count) + " elements";
+        return nullptr;
+    }
+    return arr.Data();
+}
+
+Napi::Value UpdateFdtd(const Napi::CallbackInfo &info, bool magnetic) {
+    auto env = info.Env();
+    auto dims = info[0].As<Napi::Array>();
+    FdtdGrid grid {
+        dims.Get((uint32_t) 0).As<Napi::Number>().Int32Value(),
+        dims.Get((uint32_t) 1).As<Napi::Number>().Int32Value(),
+        dims.Get((uint32_t) 2).As<Napi::Number>().Int32Value(),
+    };
+    if (grid.nx <= 0 || grid.ny <= 0 || grid.nz <= 0) {
+        Napi::Error::New(env, "grid size should be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string err;
+    auto count = grid.Count();
+    auto f = info[1].As<Napi::Object>(), c = info[2].As<Napi::Object>();
+    FdtdFields fields {
+        GetFdtdArray(f, "ex", count, false, err), GetFdtdArray(f, "ey", count, false, err),
+        GetFdtdArray(f, "ez", count, false, err), GetFdtdArray(f, "hx", count, false, err),
+        GetFdtdArray(f, "hy", count, false, err), GetFdtdArray(f, "hz", count, false, err),
+    };
+    FdtdCoefs coefs {
+        GetFdtdArray(c, "ax", count, true, err), GetFdtdArray(c, "ay", count, true, err),
+        GetFdtdArray(c, "az", count, true, err), GetFdtdArray(c, "bx", count, false, err),
+        GetFdtdArray(c, "by", count, false, err), GetFdtdArray(c, "bz", count, false, err),
+    };
+    if (!err.empty()) {
+        Napi::Error::New(env, err).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int threads = 0;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        auto opts = info[3].As<Napi::Object>();
+        if (opts.Has("threads")) {
+            threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+        }
+    }
+
+    if (magnetic) {
+        FdtdUpdateH(grid, fields, coefs, threads);
+    } else {
+        FdtdUpdateE(grid, fields, coefs, threads);
+    }
+    return env.Undefined();
+}
+
+Napi::Value UpdateH(const Napi::CallbackInfo &info) {
+    return UpdateFdtd(info, true);
+}
+
+Napi::Value UpdateE(const Napi::CallbackInfo &info) {
+    return UpdateFdtd(info, false);
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    exports.Set("test", Napi::Function::New(env, Test));
+    exports.Set("backend", Napi::Function::New(env, Backend));
+    auto fdtd = Napi::Object::New(env);
+    fdtd.Set("updateH", Napi::Function::New(env, UpdateH));
+    fdtd.Set("updateE", Napi::Function::New(env, UpdateE));
+    exports.Set("fdtd", fdtd);
+    return exports;
+}
+
+NODE_API_MODULE(binding, Init)
@@ -0,0 +1,189 @@
+#include "fdtd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512F__)
+#define FDTD_SIMD "avx512"
+typedef __m512 VecF;
+const int VecWidth = 16;
+inline VecF VecLoad(const float *p) { return _mm512_loadu_ps(p); }
+inline void VecStore(float *p, VecF v) { _mm512_storeu_ps(p, v); }
+inline VecF VecSub(VecF a, VecF b) { return _mm512_sub_ps(a, b); }
+inline VecF VecMul(VecF a, VecF b) { return _mm512_mul_ps(a, b); }
+inline VecF VecMulAdd(VecF a, VecF b, VecF c) { return _mm512_fmadd_ps(a, b, c); }
+#elif defined(__AVX2__)
+#define FDTD_SIMD "avx2"
+typedef __m256 VecF;
+const int VecWidth = 8;
+inline VecF VecLoad(const float *p) { return _mm256_loadu_ps(p); }
+inline void VecStore(float *p, VecF v) { _mm256_storeu_ps(p, v); }
+inline VecF VecSub(VecF a, VecF b) { return _mm256_sub_ps(a, b); }
+inline VecF VecMul(VecF a, VecF b) { return _mm256_mul_ps(a, b); }
+// msvc enables FMA with /arch:AVX2 without defining __FMA__
+#if defined(__FMA__) || defined(_MSC_VER)
+inline VecF VecMulAdd(VecF a, VecF b, VecF c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+inline VecF VecMulAdd(VecF a, VecF b, VecF c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+#else
+#define FDTD_SIMD "scalar"
+#endif
+
+const char *FdtdSimd() {
+    return FDTD_SIMD;
+}
+
+// f[i] = a[i] * f[i] + sign * b[i] * ((p1[i] - p0[i]) - (q1[i] - q0[i])) for i in [0, n)
+template <bool Loss, int Sign>
+void UpdateFdtdRow(float *f, const float *a, const float *b,
+        const float *p0, const float *p1, const float *q0, const float *q1, int n) {
+    int i = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+    for (; i + VecWidth <= n; i += VecWidth) {
+        auto c = VecSub(VecSub(VecLoad(p1 + i), VecLoad(p0 + i)), VecSub(VecLoad(q1 + i), VecLoad(q0 + i)));
+        auto v = Loss ? VecMul(VecLoad(a + i), VecLoad(f + i)) : VecLoad(f + i);
+        auto k = VecLoad(b + i);
+        VecStore(f + i, Sign > 0 ? VecMulAdd(k, c, v) : VecSub(v, VecMul(k, c)));
+    }
+#endif
+    for (; i < n; i ++) {
+        auto c = (p1[i] - p0[i]) - (q1[i] - q0[i]);
+        f[i] = (Loss ? a[i] * f[i] : f[i]) + Sign * b[i] * c;
+    }
+}
+
+template <int Sign>
+struct FdtdRow {
+    // coefficients of the component being updated
+    const float *a, *b;
+    void operator()(float *f, size_t o, const float *p0, const float *p1, const float *q0, const float *q1, int n) const {
+        if (a) {
+            UpdateFdtdRow<true, Sign>(f + o, a + o, b + o, p0, p1, q0, q1, n);
+        } else {
+            UpdateFdtdRow<false, Sign>(f + o, nullptr, b + o, p0, p1, q0, q1, n);
+        }
+    }
+};
+
+// rows of a tile share their neighbour rows in cache
+const int FdtdTileRows = 16;
+
+// workers are kept between calls, as starting threads costs about as much as a step of a small grid.
+// It is never freed, so no thread has to be joined while the addon is unloaded
+class FdtdPool {
+public:
+    static FdtdPool &Get() {
+        static auto pool = new FdtdPool();
+        return *pool;
+    }
+    // runs `work` on `threads` threads including the calling one, and returns after all of them finished
+    void Run(int threads, const std::function<void()> &work) {
+        std::lock_guard<std::mutex> run(runMutex);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (; started < threads - 1; started ++) {
+            std::thread(&FdtdPool::Loop, this, started, generation).detach();
+        }
+        job = &work;
+        active = pending = threads - 1;
+        generation ++;
+        lock.unlock();
+        wake.notify_all();
+        work();
+        lock.lock();
+        done.wait(lock, [this]() { return pending == 0; });
+        job = nullptr;
+    }
+private:
+    void Loop(int index, size_t seen) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return generation != seen; });
+            seen = generation;
+            if (index < active) {
+                auto work = job;
+                lock.unlock();
+                (*work)();
+                lock.lock();
+                if (-- pending == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    }
+    // one job at a time, calls may come from several node workers
+    std::mutex runMutex, mutex;
+    std::condition_variable wake, done;
+    const std::function<void()> *job = nullptr;
+    size_t generation = 0;
+    int started = 0, active = 0, pending = 0;
+};
+
+template <typename F>
+void ForEachFdtdRow(const FdtdGrid &grid, int threads, F fn) {
+    int tj = (grid.ny + FdtdTileRows - 1) / FdtdTileRows, count = tj * grid.nz;
+    std::atomic<int> next(0);
+    std::function<void()> work = [&]() {
+        for (int t; (t = next ++) < count; ) {
+            int k = t / tj, j0 = (t % tj) * FdtdTileRows, j1 = std::min(j0 + FdtdTileRows, grid.ny);
+            for (int j = j0; j < j1; j ++) {
+                fn(j, k);
+            }
+        }
+    };
+    if (threads <= 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = std::max(1, std::min(threads, count));
+    if (threads == 1) {
+        work();
+    } else {
+        FdtdPool::Get().Run(threads, work);
+    }
+}
+
+// values beyond the grid are zero, which makes the outer boundary a perfect conductor
+void FdtdUpdateH(const FdtdGrid &grid, const FdtdFields &fields, const FdtdCoefs &coefs, int threads) {
+    int nx = grid.nx, ny = grid.ny, nz = grid.nz;
+    size_t sy = nx, sz = (size_t) nx * ny;
+    std::vector<float> zero(nx, 0.f);
+    FdtdRow<-1> rx { coefs.ax, coefs.bx }, ry { coefs.ay, coefs.by }, rz { coefs.az, coefs.bz };
+    ForEachFdtdRow(grid, threads, [&](int j, int k) {
+        size_t o = j * sy + k * sz;
+        auto ex = fields.ex + o, ey = fields.ey + o, ez = fields.ez + o;
+        auto exj = j + 1 < ny ? ex + sy : zero.data(), ezj = j + 1 < ny ? ez + sy : zero.data();
+        auto exk = k + 1 < nz ? ex + sz : zero.data(), eyk = k + 1 < nz ? ey + sz : zero.data();
+        rx(fields.hx, o, ez, ezj, ey, eyk, nx);
+        ry(fields.hy, o, ex, exk, ez, ez + 1, nx - 1);
+        ry(fields.hy, o + nx - 1, ex + nx - 1, exk + nx - 1, ez + nx - 1, zero.data(), 1);
+        rz(fields.hz, o, ey, ey + 1, ex, exj, nx - 1);
+        rz(fields.hz, o + nx - 1, ey + nx - 1, zero.data(), ex + nx - 1, exj + nx - 1, 1);
+    });
+}
+
+void FdtdUpdateE(const FdtdGrid &grid, const FdtdFields &fields, const FdtdCoefs &coefs, int threads) {
+    int nx = grid.nx;
+    size_t sy = nx, sz = (size_t) nx * grid.ny;
+    std::vector<float> zero(nx, 0.f);
+    FdtdRow<1> rx { coefs.ax, coefs.bx }, ry { coefs.ay, coefs.by }, rz { coefs.az, coefs.bz };
+    ForEachFdtdRow(grid, threads, [&](int j, int k) {
+        size_t o = j * sy + k * sz;
+        auto hx = fields.hx + o, hy = fields.hy + o, hz = fields.hz + o;
+        auto hxj = j > 0 ? hx - sy : zero.data(), hzj = j > 0 ? hz - sy : zero.data();
+        auto hxk = k > 0 ? hx - sz : zero.data(), hyk = k > 0 ? hy - sz : zero.data();
+        rx(fields.ex, o, hzj, hz, hyk, hy, nx);
+        ry(fields.ey, o, hxk, hx, zero.data(), hz, 1);
+        ry(fields.ey, o + 1, hxk + 1, hx + 1, hz, hz + 1, nx - 1);
+        rz(fields.ez, o, zero.data(), hy, hxj, hx, 1);
+        rz(fields.ez, o + 1, hy, hy + 1, hxj + 1, hx + 1, nx - 1);
+    });
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+// Yee grid with fields on node-indexed edges, the edge (i, j, k) is at i + nx * (j + ny * k).
+// Fields are integral quantities (e along primal edges, h along dual edges), so the curl is a
+// plain difference and the cell geometry lives in the coefficients.
+struct FdtdGrid {
+    int nx, ny, nz;
+    size_t Count() const { return (size_t) nx * ny * nz; }
+};
+
+struct FdtdFields {
+    float *ex, *ey, *ez, *hx, *hy, *hz;
+};
+
+// h = a * h - b * curl(e) and e = a * e + b * curl(h), `a` may be null for lossless components
+struct FdtdCoefs {
+    const float *ax, *ay, *az, *bx, *by, *bz;
+};
+
+const char *FdtdSimd();
+void FdtdUpdateH(const FdtdGrid &grid, const FdtdFields &fields, const FdtdCoefs &coefs, int threads);
+void FdtdUpdateE(const FdtdGrid &grid, const FdtdFields &fields, const FdtdCoefs &coefs, int threads);
@@ -0,0 +1,27 @@
+const { backend, fdtd } = require('../')
+
+const [nx, ny, nz] = (process.argv[2] || '192,192,192').split(',').map(s => parseInt(s)),
+    steps = parseInt(process.argv[3] || '20'),
+    threads = parseInt(process.argv[4] || '0'),
+    dims = [nx, ny, nz],
+    count = nx * ny * nz,
+    fields = { },
+    coefs = { }
+for (const key of ['ex', 'ey', 'ez', 'hx', 'hy', 'hz']) {
+    fields[key] = new Float32Array(count)
+}
+for (const key of ['bx', 'by', 'bz']) {
+    coefs[key] = new Float32Array(count).fill(0.3)
+}
+
+const source = Math.floor(nx / 2) + nx * (Math.floor(ny / 2) + ny * Math.floor(nz / 2)),
+    start = process.hrtime.bigint()
+for (let i = 0; i < steps; i ++) {
+    fields.ez[source] += Math.sin(i * 0.1)
+    fdtd.updateH(dims, fields, coefs, { threads })
+    fdtd.updateE(dims, fields, coefs, { threads })
+}
+const seconds = Number(process.hrtime.bigint() - start) / 1e9
+console.log(JSON.stringify(backend()))
+console.log(`${dims.join('x')} cells, ${steps} steps in ${seconds.toFixed(3)}s`)
+console.log(`${(count * steps / seconds / 1e6).toFixed(1)} M cell updates/s`)
@@ -0,0 +1,52 @@
+const assert = require('assert'),
+    { fdtd } = require('../')
+
+// naive update of every cell, values beyond the grid are zero
+function reference([nx, ny, nz], fields, coefs) {
+    const at = (arr, i, j, k) => i < 0 || j < 0 || k < 0 || i >= nx || j >= ny || k >= nz ? 0 : arr[i + nx * (j + ny * k)],
+        { ex, ey, ez, hx, hy, hz } = fields,
+        { ax, ay, az, bx, by, bz } = coefs,
+        a = (arr, o) => arr ? arr[o] : 1
+    for (let k = 0; k < nz; k ++) for (let j = 0; j < ny; j ++) for (let i = 0; i < nx; i ++) {
+        const o = i + nx * (j + ny * k)
+        hx[o] = a(ax, o) * hx[o] - bx[o] * ((at(ez, i, j + 1, k) - at(ez, i, j, k)) - (at(ey, i, j, k + 1) - at(ey, i, j, k)))
+        hy[o] = a(ay, o) * hy[o] - by[o] * ((at(ex, i, j, k + 1) - at(ex, i, j, k)) - (at(ez, i + 1, j, k) - at(ez, i, j, k)))
+        hz[o] = a(az, o) * hz[o] - bz[o] * ((at(ey, i + 1, j, k) - at(ey, i, j, k)) - (at(ex, i, j + 1, k) - at(ex, i, j, k)))
+    }
+    for (let k = 0; k < nz; k ++) for (let j = 0; j < ny; j ++) for (let i = 0; i < nx; i ++) {
+        const o = i + nx * (j + ny * k)
+        ex[o] = a(ax, o) * ex[o] + bx[o] * ((at(hz, i, j, k) - at(hz, i, j - 1, k)) - (at(hy, i, j, k) - at(hy, i, j, k - 1)))
+        ey[o] = a(ay, o) * ey[o] + by[o] * ((at(hx, i, j, k) - at(hx, i, j, k - 1)) - (at(hz, i, j, k) - at(hz, i - 1, j, k)))
+        ez[o] = a(az, o) * ez[o] + bz[o] * ((at(hy, i, j, k) - at(hy, i - 1, j, k)) - (at(hx, i, j, k) - at(hx, i, j - 1, k)))
+    }
+}
+
+// odd sizes leave a scalar tail after the vector loop, and more than one tile of rows
+const dims = [37, 21, 13],
+    count = dims[0] * dims[1] * dims[2],
+    random = () => new Float32Array(count).map(() => Math.random() * 2 - 1),
+    fields = { },
+    expected = { },
+    coefs = { ax: random(), az: random(), bx: random(), by: random(), bz: random() }
+for (const key of ['ex', 'ey', 'ez', 'hx', 'hy', 'hz']) {
+    fields[key] = random()
+    expected[key] = new Float64Array(fields[key])
+}
+
+for (const threads of [1, 3, 0]) {
+    fdtd.updateH(dims, fields, coefs, { threads })
+    fdtd.updateE(dims, fields, coefs, { threads })
+    reference(dims, expected, coefs)
+    for (const key in fields) {
+        let err = 0
+        for (let i = 0; i < count; i ++) {
+            err = Math.max(err, Math.abs(fields[key][i] - expected[key][i]) / (1 + Math.abs(expected[key][i])))
+        }
+        assert.ok(err < 1e-4, `${key} with ${threads} threads is off by ${err}`)
+        // keep the reference in single precision like the kernel
+        expected[key].set(fields[key])
+    }
+}
+
+assert.throws(() => fdtd.updateH(dims, { ...fields, ex: new Float32Array(1) }, coefs), /should have/)
+console.log('fdtd ok')
@@ -7,7 +7,7 @@ type XYZ = Vec3 | [
     number,
     number,
     number
-]
+] | Float64Array
 
 declare enum ShapeType {
     COMPOUND,
@@ -26,24 +26,87 @@ declare class Shape {
     type: ShapeType
     meta: Record<string, string>
     find(type: ShapeType): Shape[]
+    // a copy translated by `offset` that shares the underlying shape
+    moved(offset: XYZ): Shape
     bound(): { min: Vec3, max: Vec3 }
 
     getLinearProps(): { mass: number }
     getSurfaceProps(): { mass: number }
     getVolumeProps(): { mass: number }
+    /**
+     * 128 bit hex digest of topology and geometry with coordinates rounded to `quantum` (default 1e-6),
+     * the same for identical shapes across sessions and re-imports
+     */
+    contentHash(opts?: { quantum?: number }): string
+
+    /**
+     * register the shape in a process wide table and return its handle,
+     * which can be posted to other worker threads and opened with `Shape.fromShared`
+     * note: the underlying shape is not copied, avoid meshing it from several threads at once
+     */
+    share(): number
+    static fromShared(handle: number): Shape
+    static releaseShared(handle: number): boolean
+}
+
+/**
+ * shapes of a session under stable integer ids with their attributes and cached meshes,
+ * saved and loaded as one binary snapshot so a session is restored in one call
+ */
+declare class Document {
+    size: number
+    ids(): Uint32Array
+    add(shape: Shape, attrs?: Record<string, string>): number
+    // every sub shape of the type like `shape.find(type)`, with its meta as attributes
+    addParts(shape: Shape, type: ShapeType): Uint32Array
+    remove(id: number): boolean
+    // a new wrapper with the attributes as its meta, other wrappers of the shape are not affected
+    get(id: number): Shape
+    attrs(id: number): Record<string, string>
+    // merges into the attributes, null removes a key
+    setAttrs(id: number, attrs: Record<string, string | null>): void
+    // cached until called with other options, and kept in snapshots
+    mesh(id: number, opts?: {
+        angle?: number
+        deflection?: number
+        optimize?: boolean
+    }): Mesh
+    save(file: string): void
+    save(): Buffer
+    static load(file: string | ArrayBufferView): Document
+}
+
+/**
+ * history of every input shape of a boolean, args first and then tools.
+ * faces are indexed like `shape.find(FACE)`, result faces of input face i are
+ * `faces.slice(offsets[i], offsets[i + 1])`, unchanged faces list their own index in the result
+ */
+export type BoolHistory = {
+    // bit flags, 1 for modified, 2 for generated and 4 for deleted, 0 if unchanged
+    status: Uint8Array
+    offsets: Uint32Array
+    faces: Uint32Array
+}
+export type BoolResult = {
+    shape: Shape
+    history: BoolHistory[]
 }
 
 export const brep: {
-    save(file: string, shape: Shape): void
-    save(shape: Shape): Buffer
-    load(file: string): Shape
-    load(buffer: Buffer): Shape
+    save(file: string, shape: Shape, opts?: { binary?: boolean }): void
+    save(shape: Shape, opts?: { binary?: boolean }): Buffer
+    load(file: string, opts?: { binary?: boolean }): Shape
+    load(buffer: Buffer, opts?: { binary?: boolean }): Shape
+    // binary data may be a view of SharedArrayBuffer
+    load(buffer: Uint8Array, opts: { binary: true }): Shape
     builder: {
         makeVertex(p0: XYZ): Shape
         makeEdge(p0: XYZ, p1: XYZ): Shape
         makeFace(pos: XYZ, dir: XYZ): Shape
         makeFace(wire: Shape): Shape
         makeWire(edges: Shape[]): Shape
+        // one wire through points packed as [x0, y0, z0, x1, y1, z1, ...]
+        makePolyline(points: Float64Array | number[], closed?: boolean): Shape
         makeShell(wires: Shape[]): Shape
         makeCompound(shapes: Shape[]): Shape
         makeSolid(shapes: Shape[]): Shape
@@ -52,24 +115,111 @@ export const brep: {
     primitive: {
         makeSphere(p: XYZ, r: number): Shape
         makeBox(p0: XYZ, p1: XYZ): Shape
+        // spheres packed as [x, y, z, r, ...]
+        makeSpheres(params: Float64Array | number[]): Shape[]
+        makeSpheres(params: Float64Array | number[], opts: { compound: true }): Shape
+        // boxes packed as [x0, y0, z0, x1, y1, z1, ...]
+        makeBoxes(params: Float64Array | number[]): Shape[]
+        makeBoxes(params: Float64Array | number[], opts: { compound: true }): Shape
     }
     bool: {
-        fuse(args: Shape[], tools: Shape[], opts?: { fuzzyValue?: number }): Shape
-        common(args: Shape[], tools: Shape[], opts?: { }): Shape
-        cut(args: Shape[], tools: Shape[], opts?: { }): Shape
-        section(args: Shape[], tools: Shape[], opts?: { }): Shape
-        split(args: Shape[], tools: Shape[], opts?: { }): Shape
+        fuse(args: Shape[], tools: Shape[], opts?: { fuzzyValue?: number } & Progress): Shape
+        fuse(args: Shape[], tools: Shape[], opts: { fuzzyValue?: number, history: true } & Progress): BoolResult
+        common(args: Shape[], tools: Shape[], opts?: Progress): Shape
+        common(args: Shape[], tools: Shape[], opts: { history: true } & Progress): BoolResult
+        cut(args: Shape[], tools: Shape[], opts?: Progress): Shape
+        cut(args: Shape[], tools: Shape[], opts: { history: true } & Progress): BoolResult
+        section(args: Shape[], tools: Shape[], opts?: Progress): Shape
+        section(args: Shape[], tools: Shape[], opts: { history: true } & Progress): BoolResult
+        split(args: Shape[], tools: Shape[], opts?: Progress): Shape
+        split(args: Shape[], tools: Shape[], opts: { history: true } & Progress): BoolResult
+        /**
+         * partition all bodies at once, solid `i` of `shape.find(SOLID)` is inside the inputs
+         * `bodies.subarray(offsets[i], offsets[i + 1])`
+         */
+        generalFuse(shapes: Shape[], opts?: { parallel?: boolean, fuzzy?: number } & Progress): {
+            shape: Shape
+            offsets: Uint32Array
+            bodies: Uint32Array
+        }
     }
 }
 
 export const tool: {
-    mesh(shapes: Shape[], xs: number[], ys: number[], zs: number[]): {
+    mesh(shapes: Shape[], xs: number[], ys: number[], zs: number[], opts?: Progress): {
         i: number
         j: number
         k: number
         s: number
         p: Shape
     }[]
+    /**
+     * material index (1 based position in shapes, 0 for empty) of every cell center,
+     * the cell (i, j, k) is at i + nx * (j + ny * k). Later shapes overwrite earlier ones
+     */
+    voxelize(shapes: Shape[], xs: number[], ys: number[], zs: number[], opts?: {
+        angle?: number
+        deflection?: number
+    }): Uint8Array | Uint16Array
+    /**
+     * filled fraction of every Yee cell edge and face, indexed by grid node i + nx * (j + ny * k)
+     * `lx` is the edge from xs[i] to xs[i + 1], `sx` is the face at xs[i] spanning ys[j..j+1] and zs[k..k+1]
+     */
+    conformal(shapes: Shape[], xs: number[], ys: number[], zs: number[], opts?: {
+        angle?: number
+        deflection?: number
+    }): Record<'lx' | 'ly' | 'lz' | 'sx' | 'sy' | 'sz', Float32Array>
+    /**
+     * section contours of the shape with planes normal to axis (0, 1, 2 for x, y, z).
+     * loops of plane p are from planes[p] to planes[p + 1], points of loop l are from loops[l] to loops[l + 1]
+     */
+    slices(shape: Shape, axis: number, positions: number[], opts?: {
+        angle?: number
+        deflection?: number
+    }): {
+        positions: Float32Array
+        loops: Uint32Array
+        closed: Uint8Array
+        planes: Uint32Array
+        // 1 if sectioning the plane failed, its loops are empty then
+        failed: Uint8Array
+    }
+    /**
+     * 1 based position in shapes of the solid containing each point of `points` ([x, y, z, ...]), 0 if outside,
+     * in the narrowest of Uint8Array, Uint16Array or Uint32Array that holds the number of shapes.
+     * Later shapes overwrite earlier ones. With `mesh` points are tested by ray parity on the triangulation,
+     * shapes that fail to mesh completely fall back to the exact classifier
+     */
+    classify(shapes: Shape[], points: Float64Array, opts?: {
+        tol?: number
+        mesh?: boolean
+        angle?: number
+        deflection?: number
+    } & Progress): Uint8Array | Uint16Array | Uint32Array
+    /**
+     * shape pairs `[pairs[i * 2], pairs[i * 2 + 1]]` closer than `maxDistance` (default 0, in contact),
+     * with closest points `points.subarray(i * 6, i * 6 + 6)` and `overlaps[i]` set if their volumes intersect
+     */
+    clearance(shapes: Shape[], opts?: {
+        maxDistance?: number
+    } & Progress): {
+        pairs: Uint32Array
+        distances: Float64Array
+        points: Float64Array
+        overlaps: Uint8Array
+    }
+}
+
+/**
+ * long native calls stop once the first item of `signal` is not zero
+ * (use a SharedArrayBuffer and `Atomics.store` to abort from another thread) or after `timeoutMs`,
+ * `onProgress` is called on the js thread with the finished fraction, while the work runs for `mesh.batch`,
+ * and for calls split over worker threads at least once when they return
+ */
+export type Progress = {
+    signal?: Int32Array
+    timeoutMs?: number
+    onProgress?: (fraction: number) => void
 }
 
 export type Face = {
@@ -77,6 +227,14 @@ export type Face = {
     indices: Uint32Array
     normals: Float32Array 
 }
+export type Mesh = Face & {
+    groups: Uint32Array
+}
+// row `i` is `indices.subarray(offsets[i], offsets[i + 1])`
+export type Csr = {
+    offsets: Uint32Array
+    indices: Uint32Array
+}
 export type Edge = {
     positions: Float32Array
 }
@@ -85,12 +243,82 @@ export const mesh: {
     create(shape: Shape, opts?: {
         angle?: number
         deflection?: number
-    }): Face
+        // reorder triangles of every face for the vertex cache, and vertices by first use
+        optimize?: boolean
+    } & Progress): Mesh
+    /**
+     * mesh shapes on native threads, results are passed to `onMesh` as soon as they are ready
+     * resolves with the number of shapes if `onMesh` is given, or all meshes otherwise
+     */
+    batch(shapes: Shape[], opts?: {
+        angle?: number
+        deflection?: number
+        optimize?: boolean
+        concurrency?: number
+        // bytes of finished meshes not yet passed to js, before pausing the threads
+        memoryBudget?: number
+        onMesh?: (mesh: Mesh, index: number) => void
+    } & Progress): Promise<number | Mesh[]>
+    /**
+     * write binary gltf with one node per shape, named and colored from step metadata
+     * `target` is a file path, or a callback receiving chunks; returns the buffer if omitted
+     */
+    exportGlb(shapes: Shape[], target?: string | ((chunk: Buffer) => void), opts?: {
+        angle?: number
+        deflection?: number
+        optimize?: boolean
+    } & Progress): number | Buffer
+    exportStl(shapes: Shape[], target?: string | ((chunk: Buffer) => void), opts?: {
+        angle?: number
+        deflection?: number
+    } & Progress): number | Buffer
+    /**
+     * mesh each distinct solid of `shape` once, instance `i` is `shape.find(SOLID)[i]`
+     * drawn with `prototypes[instances[i]]` and the column major matrix `transforms.subarray(i * 16, i * 16 + 16)`
+     */
+    instances(shape: Shape, opts?: {
+        angle?: number
+        deflection?: number
+        optimize?: boolean
+    } & Progress): {
+        prototypes: Mesh[]
+        instances: Uint32Array
+        transforms: Float32Array
+    }
+    /**
+     * split a mesh into clusters that never cross face groups, cluster `i` uses
+     * `vertices.subarray(meshlets[i * 4], meshlets[i * 4] + meshlets[i * 4 + 1])`
+     * and `meshlets[i * 4 + 3]` triangles of local indices from `triangles[meshlets[i * 4 + 2]]`.
+     * `bounds` holds sphere center, radius, cone axis and cutoff per cluster, which is backfacing when
+     * `dot(center - camera, axis) >= cutoff * length(center - camera) + radius`
+     */
+    meshlets(mesh: Mesh | Face, opts?: {
+        // at most 256
+        maxVerts?: number
+        maxTris?: number
+    }): {
+        meshlets: Uint32Array
+        groups: Uint32Array
+        vertices: Uint32Array
+        triangles: Uint8Array
+        bounds: Float32Array
+    }
+    /**
+     * parse an obj file or buffer into the layout of `mesh.create`, group `i` is named `names[i]` by its `g` or `o` statement.
+     * `toShape` also builds a shape with a planar face per triangle, made a solid where the part is closed
+     */
+    loadObj(file: string | Buffer, opts?: {
+        optimize?: boolean
+        toShape?: boolean
+    } & Progress): Mesh & {
+        names: string[]
+        shape?: Shape
+    }
     poly(shape: Shape, opts?: {
         angle?: number
         deflection?: number
         tol?: number
-    }): {
+    } & Progress): {
         positions: Float32Array
         indices: Uint32Array
         groups: Uint32Array[]
@@ -98,15 +326,37 @@ export const mesh: {
     topo(shape: Shape, opts?: {
         angle?: number
         deflection?: number
-    }): {
+        // only mesh and return these faces, indexed like `shape.find(FACE)`
+        faces?: number[]
+    } & Progress): {
         geom: Face
         verts: Float32Array
-        faces: Face[]
-        edges: Edge[]
+        faces: (Face & { index: number })[]
+        edges: (Edge & { index: number })[]
+        // indexed like `shape.find(FACE/EDGE/VERTEX)`
+        adjacency: {
+            faceEdges: Csr
+            edgeFaces: Csr
+            edgeVerts: Csr
+            verts: Float64Array
+        }
     }
 }
 
 export const step: {
     save(file: string, shape: Shape): void
-    load(file: string): Shape
+    load(file: string, opts?: Progress): Shape
+    /**
+     * transfer the roots one at a time and pass each one, or compounds of `batch` solids, to `onShape`.
+     * `release` (default true) drops the transfer results after every root to bound memory,
+     * at the cost of shapes shared by roots being transferred again. `memoryGrowth` is the largest rise
+     * of the working set in bytes over the call, sampled after the read and after every root, -1 if unknown
+     */
+    stream(file: string, onShape: (shape: Shape, root: number) => void, opts?: {
+        batch?: number
+        release?: boolean
+    } & Progress): {
+        roots: number
+        memoryGrowth: number
+    }
 }
@@ -1,9 +1,10 @@
 const download = require('download'),
     os = require('os')
 
+// OCCT 7.6 or later is required (binary BRep format versions, progress ranges)
 download(os.platform() === 'win32' ?
         'https://prebuilt.oss-cn-shanghai.aliyuncs.com/occt-7.7.zip' :
-        'https://prebuilt.oss-cn-shanghai.aliyuncs.com/occt-7.4.tar.gz',
+        'https://prebuilt.oss-cn-shanghai.aliyuncs.com/occt-7.7.tar.gz',
     'deps', {
         extract: true,
     })
@@ -4,22 +4,37 @@
 #include "brep/bool.h"
 #include "brep/brep.h"
 #include "topo/shape.h"
+#include "topo/document.h"
 #include "step/step.h"
 #include "tool/mesh.h"
+#include "tool/voxel.h"
+#include "tool/conformal.h"
+#include "tool/slice.h"
+#include "tool/clearance.h"
+#include "tool/classify.h"
 #include "mesh/mesh.h"
+#include "mesh/export.h"
+#include "mesh/meshlet.h"
+#include "mesh/obj.h"
+#include "utils.h"
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    SetInstanceData(env);
+
     auto brep = Napi::Object::New(env);
 
     auto primitive = Napi::Object::New(env);
     primitive.Set("makeSphere", Napi::Function::New(env, MakeSphere));
     primitive.Set("makeBox", Napi::Function::New(env, MakeBox));
+    primitive.Set("makeSpheres", Napi::Function::New(env, MakeSpheres));
+    primitive.Set("makeBoxes", Napi::Function::New(env, MakeBoxes));
     brep.Set("primitive", primitive);
 
     auto builder = Napi::Object::New(env);
     builder.Set("makeVertex", Napi::Function::New(env, MakeVertex));
     builder.Set("makeEdge", Napi::Function::New(env, MakeEdge));
     builder.Set("makeWire", Napi::Function::New(env, MakeWire));
+    builder.Set("makePolyline", Napi::Function::New(env, MakePolyline));
     builder.Set("makeShell", Napi::Function::New(env, MakeShell));
     builder.Set("makeFace", Napi::Function::New(env, MakeFace));
     builder.Set("makeCompound", Napi::Function::New(env, MakeCompound));
@@ -33,6 +48,7 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     boolean.Set("cut", Napi::Function::New(env, cut));
     boolean.Set("section", Napi::Function::New(env, section));
     boolean.Set("split", Napi::Function::New(env, split));
+    boolean.Set("generalFuse", Napi::Function::New(env, generalFuse));
     brep.Set("bool", boolean);
 
     brep.Set("save", Napi::Function::New(env, SaveBrep));
@@ -42,19 +58,32 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     auto step = Napi::Object::New(env);
     step.Set("save", Napi::Function::New(env, SaveStep));
     step.Set("load", Napi::Function::New(env, LoadStep));
+    step.Set("stream", Napi::Function::New(env, StreamStep));
     exports.Set("step", step);
 
     auto tool = Napi::Object::New(env);
     tool.Set("mesh", Napi::Function::New(env, MakeMesh));
+    tool.Set("voxelize", Napi::Function::New(env, Voxelize));
+    tool.Set("conformal", Napi::Function::New(env, MakeConformal));
+    tool.Set("slices", Napi::Function::New(env, MakeSlices));
+    tool.Set("clearance", Napi::Function::New(env, MakeClearance));
+    tool.Set("classify", Napi::Function::New(env, Classify));
     exports.Set("tool", tool);
 
     auto mesh = Napi::Object::New(env);
     mesh.Set("create", Napi::Function::New(env, CreateMesh));
     mesh.Set("topo", Napi::Function::New(env, CreateTopo));
     mesh.Set("poly", Napi::Function::New(env, CreatePoly));
+    mesh.Set("batch", Napi::Function::New(env, BatchMesh));
+    mesh.Set("instances", Napi::Function::New(env, CreateInstances));
+    mesh.Set("meshlets", Napi::Function::New(env, CreateMeshlets));
+    mesh.Set("exportGlb", Napi::Function::New(env, ExportGlb));
+    mesh.Set("exportStl", Napi::Function::New(env, ExportStl));
+    mesh.Set("loadObj", Napi::Function::New(env, LoadObj));
     exports.Set("mesh", mesh);
 
     Shape::Init(env, exports);
+    Document::Init(env, exports);
     return exports;
 }
 
@@ -5,8 +5,18 @@
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Section.hxx>
 #include <BRepAlgoAPI_Splitter.hxx>
+#include <BOPAlgo_Builder.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 
 #include "../topo/shape.h"
+#include "../progress.h"
+
+enum HistoryFlag {
+    HISTORY_MODIFIED = 1,
+    HISTORY_GENERATED = 2,
+    HISTORY_DELETED = 4,
+};
 
 TopoDS_ListOfShape &arr2list(Napi::Array arr, TopoDS_ListOfShape &list) {
     for (int i = 0, n = arr.Length(); i < n; i ++) {
@@ -16,6 +26,86 @@ TopoDS_ListOfShape &arr2list(Napi::Array arr, TopoDS_ListOfShape &list) {
     return list;
 }
 
+// for every face of the inputs, lists the faces of the result it became.
+// unchanged faces are listed as themselves, indices follow `shape.find(FACE)`
+Napi::Value GetHistory(Napi::Env env, BRepAlgoAPI_BuilderAlgo &api, const TopTools_ListOfShape &args, const TopTools_ListOfShape &tools) {
+    TopTools_IndexedMapOfShape result;
+    TopExp::MapShapes(api.Shape(), TopAbs_FACE, result);
+    TopTools_ListOfShape inputs(args);
+    TopTools_ListOfShape copy(tools);
+    inputs.Append(copy);
+
+    auto ret = Napi::Array::New(env);
+    uint32_t num = 0;
+    for (TopTools_ListIteratorOfListOfShape it(inputs); it.More(); it.Next()) {
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(it.Value(), TopAbs_FACE, faces);
+        auto status = Napi::Uint8Array::New(env, faces.Extent());
+        auto offsets = Napi::Uint32Array::New(env, faces.Extent() + 1);
+        std::vector<uint32_t> indices;
+        for (int i = 1; i <= faces.Extent(); i ++) {
+            auto &face = faces(i);
+            uint8_t flag = 0;
+            for (TopTools_ListIteratorOfListOfShape m(api.Modified(face)); m.More(); m.Next()) {
+                if (auto idx = result.FindIndex(m.Value())) {
+                    flag |= HISTORY_MODIFIED;
+                    indices.push_back(idx - 1);
+                }
+            }
+            for (TopTools_ListIteratorOfListOfShape m(api.Generated(face)); m.More(); m.Next()) {
+                if (auto idx = result.FindIndex(m.Value())) {
+                    flag |= HISTORY_GENERATED;
+                    indices.push_back(idx - 1);
+                }
+            }
+            if (api.IsDeleted(face)) {
+                flag |= HISTORY_DELETED;
+            } else if (!flag) {
+                if (auto idx = result.FindIndex(face)) {
+                    indices.push_back(idx - 1);
+                }
+            }
+            status[i - 1] = flag;
+            offsets[i] = (uint32_t) indices.size();
+        }
+        auto arr = Napi::Uint32Array::New(env, indices.size());
+        std::copy(indices.begin(), indices.end(), arr.Data());
+        auto item = Napi::Object::New(env);
+        item.Set("status", status);
+        item.Set("offsets", offsets);
+        item.Set("faces", arr);
+        ret.Set(num ++, item);
+    }
+    return ret;
+}
+
+Napi::Value MakeResult(const Napi::CallbackInfo &info, BRepAlgoAPI_BuilderAlgo &api, const TopTools_ListOfShape &args, const TopTools_ListOfShape &tools) {
+    auto shape = Shape::Create(info.Env(), api.Shape());
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto opts = info[2].As<Napi::Object>();
+        if (opts.Has("history") && opts.Get("history").ToBoolean().Value()) {
+            auto ret = Napi::Object::New(info.Env());
+            ret.Set("shape", shape);
+            ret.Set("history", GetHistory(info.Env(), api, args, tools));
+            return ret;
+        }
+    }
+    return shape;
+}
+
+Napi::Value BuildResult(const Napi::CallbackInfo &info, BRepAlgoAPI_BuilderAlgo &api, const TopTools_ListOfShape &args, const TopTools_ListOfShape &tools, const std::string &name) {
+    auto progress = GetProgress(info, 2);
+    api.Build(progress->Start());
+    if (ThrowIfStopped(info.Env(), progress, name)) {
+        return info.Env().Undefined();
+    } else if (api.HasErrors()) {
+        Napi::Error::New(info.Env(), name + " Failed").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    } else {
+        return MakeResult(info, api, args, tools);
+    }
+}
+
 Napi::Value fuse(const Napi::CallbackInfo &info) {
     BRepAlgoAPI_Fuse api;
     TopTools_ListOfShape args, tools;
@@ -31,13 +121,7 @@ Napi::Value fuse(const Napi::CallbackInfo &info) {
         // https://www.opencascade.com/doc/occt-7.3.0/overview/html/occt_user_guides__boolean_operations.html
     }
 
-    api.Build();
-    if (api.HasErrors()) {
-        Napi::Error::New(info.Env(), "Fuse Failed").ThrowAsJavaScriptException();
-        return info.Env().Undefined();
-    } else {
-        return Shape::Create(api.Shape());
-    }
+    return BuildResult(info, api, args, tools, "Fuse");
 }
 
 Napi::Value common(const Napi::CallbackInfo &info) {
@@ -46,13 +130,7 @@ Napi::Value common(const Napi::CallbackInfo &info) {
     api.SetArguments(arr2list(info[0].As<Napi::Array>(), args));
     api.SetTools(arr2list(info[1].As<Napi::Array>(), tools));
 
-    api.Build();
-    if (api.HasErrors()) {
-        Napi::Error::New(info.Env(), "Common Failed").ThrowAsJavaScriptException();
-        return info.Env().Undefined();
-    } else {
-        return Shape::Create(api.Shape());
-    }
+    return BuildResult(info, api, args, tools, "Common");
 }
 
 Napi::Value cut(const Napi::CallbackInfo &info) {
@@ -61,13 +139,7 @@ Napi::Value cut(const Napi::CallbackInfo &info) {
     api.SetArguments(arr2list(info[0].As<Napi::Array>(), args));
     api.SetTools(arr2list(info[1].As<Napi::Array>(), tools));
 
-    api.Build();
-    if (api.HasErrors()) {
-        Napi::Error::New(info.Env(), "Cut Failed").ThrowAsJavaScriptException();
-        return info.Env().Undefined();
-    } else {
-        return Shape::Create(api.Shape());
-    }
+    return BuildResult(info, api, args, tools, "Cut");
 }
 
 Napi::Value section(const Napi::CallbackInfo &info) {
@@ -76,13 +148,7 @@ Napi::Value section(const Napi::CallbackInfo &info) {
     api.SetArguments(arr2list(info[0].As<Napi::Array>(), args));
     api.SetTools(arr2list(info[1].As<Napi::Array>(), tools));
 
-    api.Build();
-    if (api.HasErrors()) {
-        Napi::Error::New(info.Env(), "Section Failed").ThrowAsJavaScriptException();
-        return info.Env().Undefined();
-    } else {
-        return Shape::Create(api.Shape());
-    }
+    return BuildResult(info, api, args, tools, "Section");
 }
 
 Napi::Value split(const Napi::CallbackInfo &info) {
@@ -91,11 +157,71 @@ Napi::Value split(const Napi::CallbackInfo &info) {
     api.SetArguments(arr2list(info[0].As<Napi::Array>(), args));
     api.SetTools(arr2list(info[1].As<Napi::Array>(), tools));
 
-    api.Build();
-    if (api.HasErrors()) {
-        Napi::Error::New(info.Env(), "Split Failed").ThrowAsJavaScriptException();
+    return BuildResult(info, api, args, tools, "Split");
+}
+
+// partitions all the bodies in one run, overlapped regions become solids of their own.
+// `bodies` lists the input indices every solid of the result (indexed like `shape.find(SOLID)`) is inside
+Napi::Value generalFuse(const Napi::CallbackInfo &info) {
+    BOPAlgo_Builder api;
+    TopTools_ListOfShape args;
+    api.SetArguments(arr2list(info[0].As<Napi::Array>(), args));
+    // inputs may still be used from js
+    api.SetNonDestructive(Standard_True);
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("parallel")) {
+            api.SetRunParallel(opts.Get("parallel").ToBoolean().Value());
+        }
+        if (opts.Has("fuzzy")) {
+            api.SetFuzzyValue(opts.Get("fuzzy").As<Napi::Number>().DoubleValue());
+        }
+    }
+
+    auto progress = GetProgress(info, 1);
+    api.Perform(progress->Start());
+    if (ThrowIfStopped(info.Env(), progress, "GeneralFuse")) {
         return info.Env().Undefined();
-    } else {
-        return Shape::Create(api.Shape());
+    } else if (api.HasErrors()) {
+        Napi::Error::New(info.Env(), "GeneralFuse Failed").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    TopTools_IndexedMapOfShape result;
+    TopExp::MapShapes(api.Shape(), TopAbs_SOLID, result);
+    std::vector<std::vector<uint32_t>> owners(result.Extent());
+    uint32_t num = 0;
+    for (TopTools_ListIteratorOfListOfShape it(args); it.More(); it.Next(), num ++) {
+        TopTools_IndexedMapOfShape solids;
+        TopExp::MapShapes(it.Value(), TopAbs_SOLID, solids);
+        for (int i = 1; i <= solids.Extent(); i ++) {
+            auto &solid = solids(i);
+            TopTools_ListOfShape images(api.Modified(solid));
+            if (images.IsEmpty() && !api.IsDeleted(solid)) {
+                images.Append(solid);
+            }
+            for (TopTools_ListIteratorOfListOfShape m(images); m.More(); m.Next()) {
+                if (auto idx = result.FindIndex(m.Value())) {
+                    auto &list = owners[idx - 1];
+                    if (list.empty() || list.back() != num) {
+                        list.push_back(num);
+                    }
+                }
+            }
+        }
+    }
+
+    auto offsets = Napi::Uint32Array::New(info.Env(), owners.size() + 1);
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < owners.size(); i ++) {
+        indices.insert(indices.end(), owners[i].begin(), owners[i].end());
+        offsets[i + 1] = (uint32_t) indices.size();
     }
+    auto bodies = Napi::Uint32Array::New(info.Env(), indices.size());
+    std::copy(indices.begin(), indices.end(), bodies.Data());
+    auto ret = Napi::Object::New(info.Env());
+    ret.Set("shape", Shape::Create(info.Env(), api.Shape()));
+    ret.Set("offsets", offsets);
+    ret.Set("bodies", bodies);
+    return ret;
 }
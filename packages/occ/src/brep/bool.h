@@ -5,3 +5,4 @@ Napi::Value common(const Napi::CallbackInfo &info);
 Napi::Value cut(const Napi::CallbackInfo &info);
 Napi::Value section(const Napi::CallbackInfo &info);
 Napi::Value split(const Napi::CallbackInfo &info);
+Napi::Value generalFuse(const Napi::CallbackInfo &info);
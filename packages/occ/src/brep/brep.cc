@@ -1,24 +1,64 @@
 #include "brep.h"
 
+#include <fstream>
+
 #include <BRep_Builder.hxx>
 #include <BRepTools.hxx>
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
 
 #include "../topo/shape.h"
 
+static bool isBinary(const Napi::CallbackInfo &info, size_t idx) {
+    if (info.Length() > idx && info[idx].IsObject()) {
+        auto opts = info[idx].As<Napi::Object>();
+        return opts.Has("binary") && opts.Get("binary").ToBoolean().Value();
+    }
+    return false;
+}
+
 Napi::Value LoadBrep(const Napi::CallbackInfo &info) {
     TopoDS_Shape shape;
     BRep_Builder builder;
-    if (info[0].IsString()) {
+    if (isBinary(info, 1)) {
+        // also accepts views of SharedArrayBuffer, which are not node buffers
+        std::string error;
+        try {
+            if (info[0].IsString()) {
+                std::string file = info[0].As<Napi::String>();
+                if (!BinTools::Read(shape, file.c_str())) {
+                    error = std::string("failed to read ") + file;
+                }
+            } else if (info[0].IsTypedArray() && info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+                auto arr = info[0].As<Napi::Uint8Array>();
+                std::istringstream stream(std::string((char *) arr.Data(), arr.ElementLength()));
+                // the stream overload reports nothing, so a truncated buffer shows as a failed stream or a null shape
+                BinTools::Read(shape, stream);
+                if (stream.fail() || shape.IsNull()) {
+                    error = "failed to read binary brep";
+                }
+            } else {
+                error = "Only file name or Uint8Array supported";
+            }
+        } catch (Standard_Failure &err) {
+            error = std::string("failed to read binary brep: ") + err.GetMessageString();
+        }
+        if (!error.empty()) {
+            Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+            return info.Env().Undefined();
+        }
+        return Shape::Create(info.Env(), shape);
+    } else if (info[0].IsString()) {
         std::string file = info[0].As<Napi::String>();
         if (!BRepTools::Read(shape, file.c_str(), builder)) {
             auto msg = std::string("failed to read ") + file;
             Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
         }
-        return Shape::Create(shape);
+        return Shape::Create(info.Env(), shape);
     } else if (info[0].IsBuffer()) {
         std::istringstream stream(info[0].As<Napi::Buffer<char>>().Data());
         BRepTools::Read(shape, stream, builder);
-        return Shape::Create(shape);
+        return Shape::Create(info.Env(), shape);
     } else {
         Napi::Error::New(info.Env(), "Only file name or buffer supported").ThrowAsJavaScriptException();
         return info.Env().Undefined();
@@ -26,7 +66,26 @@ Napi::Value LoadBrep(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value SaveBrep(const Napi::CallbackInfo &info) {
-    if (info[0].IsString()) {
+    if (info[0].IsString() && isBinary(info, 2)) {
+        std::string file = info[0].As<Napi::String>();
+        auto &shape = Shape::Unwrap(info[1].As<Napi::Object>())->shape;
+        std::ofstream stream(file, std::ios::binary);
+        // triangulations are kept so the receiver does not need to mesh again
+        if (stream) {
+            BinTools::Write(shape, stream, Standard_True, Standard_False, BinTools_FormatVersion_CURRENT);
+        }
+        if (!stream) {
+            auto msg = std::string("failed to write ") + file;
+            Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        }
+        return info.Env().Null();
+    } else if (isBinary(info, 1)) {
+        auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+        std::ostringstream stream(std::ios::binary);
+        BinTools::Write(shape, stream, Standard_True, Standard_False, BinTools_FormatVersion_CURRENT);
+        auto str = stream.str();
+        return Napi::Buffer<char>::Copy(info.Env(), str.c_str(), str.size());
+    } else if (info[0].IsString()) {
         std::string file = info[0].As<Napi::String>();
         auto &shape = Shape::Unwrap(info[1].As<Napi::Object>())->shape;
         if (!BRepTools::Write(shape, file.c_str())) {
@@ -4,6 +4,7 @@
 #include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepBuilderAPI_MakeWire.hxx>
+#include <BRepBuilderAPI_MakePolygon.hxx>
 #include <BRepBuilderAPI_MakeShell.hxx>
 #include <BRepBuilderAPI_NurbsConvert.hxx>
 #include <BRep_Builder.hxx>
@@ -28,32 +29,48 @@ auto fromShapes(const Napi::Array &arr, BRep_Builder &builder, TopoDS_Shape &ret
 
 Napi::Value MakeVertex(const Napi::CallbackInfo &info) {
     auto p0 = obj2pt(info[0]);
-    return Shape::Create(BRepBuilderAPI_MakeVertex(p0).Vertex());
+    return Shape::Create(info.Env(), BRepBuilderAPI_MakeVertex(p0).Vertex());
 }
 
 Napi::Value MakeEdge(const Napi::CallbackInfo &info) {
     if (info.Length() == 2) {
         auto p0 = obj2pt(info[0]), p1 = obj2pt(info[1]);
-        return Shape::Create(BRepBuilderAPI_MakeEdge(p0, p1).Edge());
+        return Shape::Create(info.Env(), BRepBuilderAPI_MakeEdge(p0, p1).Edge());
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
         return info.Env().Undefined();
     }
 }
 
+Napi::Value MakePolyline(const Napi::CallbackInfo &info) {
+    auto arr = toDoubleArr(info[0]);
+    BRepBuilderAPI_MakePolygon api;
+    for (size_t i = 0; i + 2 < arr.size(); i += 3) {
+        api.Add(gp_Pnt(arr[i], arr[i + 1], arr[i + 2]));
+    }
+    if (info.Length() > 1 && info[1].ToBoolean().Value()) {
+        api.Close();
+    }
+    if (!api.IsDone()) {
+        Napi::Error::New(info.Env(), "MakePolyline Failed").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+    return Shape::Create(info.Env(), api.Wire());
+}
+
 Napi::Value MakeFace(const Napi::CallbackInfo &info) {
     if (info.Length() == 1 && info[0].IsArray()) {
         TopoDS_Face ret;
         BRep_Builder builder;
         builder.MakeFace(ret);
-        return Shape::Create(fromShapes(info[0].As<Napi::Array>(), builder, ret));
+        return Shape::Create(info.Env(), fromShapes(info[0].As<Napi::Array>(), builder, ret));
     } else if (info.Length() == 1) {
         auto wire = Shape::Unwrap(info[0].As<Napi::Object>());
-        return Shape::Create(BRepBuilderAPI_MakeFace(TopoDS::Wire(wire->shape)));
+        return Shape::Create(info.Env(), BRepBuilderAPI_MakeFace(TopoDS::Wire(wire->shape)));
     } else if (info.Length() == 2) {
         auto pos = obj2pt(info[0]), dir = obj2pt(info[1]);
         auto plane = gp_Pln(pos, gp_Dir(dir.XYZ()));
-        return Shape::Create(BRepBuilderAPI_MakeFace(plane).Face());
+        return Shape::Create(info.Env(), BRepBuilderAPI_MakeFace(plane).Face());
     // TODO
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
@@ -66,7 +83,7 @@ Napi::Value MakeWire(const Napi::CallbackInfo &info) {
         TopoDS_Wire ret;
         BRep_Builder builder;
         builder.MakeWire(ret);
-        return Shape::Create(fromShapes(info[0].As<Napi::Array>(), builder, ret));
+        return Shape::Create(info.Env(), fromShapes(info[0].As<Napi::Array>(), builder, ret));
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
         return info.Env().Undefined();
@@ -78,7 +95,7 @@ Napi::Value MakeShell(const Napi::CallbackInfo &info) {
         TopoDS_Shell ret;
         BRep_Builder builder;
         builder.MakeShell(ret);
-        return Shape::Create(fromShapes(info[0].As<Napi::Array>(), builder, ret));
+        return Shape::Create(info.Env(), fromShapes(info[0].As<Napi::Array>(), builder, ret));
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
         return info.Env().Undefined();
@@ -90,7 +107,7 @@ Napi::Value MakeCompound(const Napi::CallbackInfo &info) {
         TopoDS_Compound ret;
         BRep_Builder builder;
         builder.MakeCompound(ret);
-        return Shape::Create(fromShapes(info[0].As<Napi::Array>(), builder, ret));
+        return Shape::Create(info.Env(), fromShapes(info[0].As<Napi::Array>(), builder, ret));
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
         return info.Env().Undefined();
@@ -102,7 +119,7 @@ Napi::Value MakeSolid(const Napi::CallbackInfo &info) {
         TopoDS_Solid ret;
         BRep_Builder builder;
         builder.MakeSolid(ret);
-        return Shape::Create(fromShapes(info[0].As<Napi::Array>(), builder, ret));
+        return Shape::Create(info.Env(), fromShapes(info[0].As<Napi::Array>(), builder, ret));
     } else {
         Napi::Error::New(info.Env(), "not implemented yet").ThrowAsJavaScriptException();
         return info.Env().Undefined();
@@ -112,5 +129,5 @@ Napi::Value MakeSolid(const Napi::CallbackInfo &info) {
 Napi::Value ToNurbs(const Napi::CallbackInfo &info) {
     auto shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
     auto nurbs = BRepBuilderAPI_NurbsConvert(shape);
-    return Shape::Create(nurbs);
+    return Shape::Create(info.Env(), nurbs);
 }
@@ -1,17 +1,95 @@
 #include "primitive.h"
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <BRepPrimAPI_MakeSphere.hxx>
+#include <BRep_Builder.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS_Compound.hxx>
 
 #include "../topo/shape.h"
 #include "../utils.h"
 
+// invalid sizes raise Standard_Failure, which would abort the process on the js thread
+Napi::Value ThrowPrimitiveError(Napi::Env env, const std::string &name, Standard_Failure &err) {
+    auto msg = name + " failed: " + err.GetMessageString();
+    Napi::Error::New(env, msg).ThrowAsJavaScriptException();
+    return env.Undefined();
+}
+
 Napi::Value MakeSphere(const Napi::CallbackInfo &info) {
     auto p = obj2pt(info[0]);
     auto r = info[1].As<Napi::Number>().DoubleValue();
-    return Shape::Create(BRepPrimAPI_MakeSphere(p, r));
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    try {
+        return Shape::Create(info.Env(), BRepPrimAPI_MakeSphere(p, r));
+    } catch (Standard_Failure &err) {
+        return ThrowPrimitiveError(info.Env(), "makeSphere", err);
+    }
 }
 
 Napi::Value MakeBox(const Napi::CallbackInfo &info) {
     auto p0 = obj2pt(info[0]), p1 = obj2pt(info[1]);
-    return Shape::Create(BRepPrimAPI_MakeBox(p0, p1).Shape());
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    try {
+        return Shape::Create(info.Env(), BRepPrimAPI_MakeBox(p0, p1).Shape());
+    } catch (Standard_Failure &err) {
+        return ThrowPrimitiveError(info.Env(), "makeBox", err);
+    }
+}
+
+// shapes are returned in one compound with { compound: true }, saving a js wrapper for each of them
+Napi::Value MakePrimitives(const Napi::CallbackInfo &info, const std::vector<TopoDS_Shape> &shapes) {
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("compound") && opts.Get("compound").ToBoolean().Value()) {
+            TopoDS_Compound ret;
+            BRep_Builder builder;
+            builder.MakeCompound(ret);
+            for (auto &shape : shapes) {
+                builder.Add(ret, shape);
+            }
+            return Shape::Create(info.Env(), ret);
+        }
+    }
+    auto ret = Napi::Array::New(info.Env(), shapes.size());
+    for (uint32_t i = 0; i < shapes.size(); i ++) {
+        ret.Set(i, Shape::Create(info.Env(), shapes[i]));
+    }
+    return ret;
+}
+
+Napi::Value MakeSpheres(const Napi::CallbackInfo &info) {
+    auto arr = toDoubleArr(info[0]);
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    std::vector<TopoDS_Shape> shapes;
+    try {
+        for (size_t i = 0; i + 3 < arr.size(); i += 4) {
+            shapes.push_back(BRepPrimAPI_MakeSphere(gp_Pnt(arr[i], arr[i + 1], arr[i + 2]), arr[i + 3]).Shape());
+        }
+    } catch (Standard_Failure &err) {
+        return ThrowPrimitiveError(info.Env(), "makeSpheres item " + std::to_string(shapes.size()), err);
+    }
+    return MakePrimitives(info, shapes);
+}
+
+Napi::Value MakeBoxes(const Napi::CallbackInfo &info) {
+    auto arr = toDoubleArr(info[0]);
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    std::vector<TopoDS_Shape> shapes;
+    try {
+        for (size_t i = 0; i + 5 < arr.size(); i += 6) {
+            auto p0 = gp_Pnt(arr[i], arr[i + 1], arr[i + 2]), p1 = gp_Pnt(arr[i + 3], arr[i + 4], arr[i + 5]);
+            shapes.push_back(BRepPrimAPI_MakeBox(p0, p1).Shape());
+        }
+    } catch (Standard_Failure &err) {
+        return ThrowPrimitiveError(info.Env(), "makeBoxes item " + std::to_string(shapes.size()), err);
+    }
+    return MakePrimitives(info, shapes);
 }
@@ -2,3 +2,5 @@
 
 Napi::Value MakeSphere(const Napi::CallbackInfo &info);
 Napi::Value MakeBox(const Napi::CallbackInfo &info);
+Napi::Value MakeSpheres(const Napi::CallbackInfo &info);
+Napi::Value MakeBoxes(const Napi::CallbackInfo &info);
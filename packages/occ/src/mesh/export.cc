@@ -0,0 +1,345 @@
+#include "export.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRep_Tool.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <gp_Vec.hxx>
+
+#include "../topo/shape.h"
+#include "mesh.h"
+#include "../progress.h"
+
+// writes to a file, to a js callback in chunks, or to one buffer returned at the end.
+// The total size is known before the first write, so the returned buffer is allocated once and filled in place
+class ExportSink {
+public:
+    ExportSink(const Napi::CallbackInfo &info, size_t idx) : env(info.Env()) {
+        if (info.Length() > idx && info[idx].IsString()) {
+            file = info[idx].As<Napi::String>();
+            stream.open(file, std::ios::binary);
+        } else if (info.Length() > idx && info[idx].IsFunction()) {
+            callback = Napi::Persistent(info[idx].As<Napi::Function>());
+        }
+    }
+    bool IsOpen() {
+        return file.empty() || stream.is_open();
+    }
+    void Begin(size_t total) {
+        if (file.empty() && callback.IsEmpty()) {
+            output = Napi::Buffer<char>::New(env, total);
+        }
+    }
+    void Write(const void *data, size_t size) {
+        if (!file.empty()) {
+            stream.write((const char *) data, size);
+        } else if (callback.IsEmpty()) {
+            auto room = output.IsEmpty() ? 0 : output.Length() - std::min(written, output.Length());
+            if (room) {
+                memcpy(output.Data() + written, data, std::min(size, room));
+            }
+        } else {
+            buffer.append((const char *) data, size);
+            if (buffer.size() >= ChunkSize) {
+                Flush();
+            }
+        }
+        written += size;
+    }
+    void Pad(size_t size, char fill = 0) {
+        std::string pad(size, fill);
+        Write(pad.data(), size);
+    }
+    Napi::Value Finish() {
+        if (!file.empty()) {
+            // the stream state is sticky, so one check covers every write and the final flush
+            stream.close();
+            if (stream.fail()) {
+                auto msg = std::string("failed to write ") + file;
+                Napi::Error::New(env, msg).ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            return Napi::Number::New(env, (double) written);
+        } else if (!callback.IsEmpty()) {
+            Flush();
+            return Napi::Number::New(env, (double) written);
+        } else {
+            return output;
+        }
+    }
+    std::string file;
+private:
+    static const size_t ChunkSize = 4 << 20;
+    void Flush() {
+        if (buffer.size()) {
+            callback.Call({ Napi::Buffer<char>::Copy(env, buffer.data(), buffer.size()) });
+            buffer.clear();
+        }
+    }
+    Napi::Env env;
+    std::ofstream stream;
+    Napi::FunctionReference callback;
+    std::string buffer;
+    Napi::Buffer<char> output;
+    size_t written = 0;
+};
+
+struct MeshStats {
+    size_t nodes = 0, triangles = 0;
+    float min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+};
+
+// counted from the face triangulations, so the layout is known before any data is written
+MeshStats CountMesh(const TopoDS_Shape &shape) {
+    MeshStats ret;
+    TopLoc_Location loc;
+    for (TopExp_Explorer ex(shape, TopAbs_FACE); ex.More(); ex.Next()) {
+        auto mesh = BRep_Tool::Triangulation(TopoDS::Face(ex.Current()), loc);
+        if (!mesh) {
+            continue;
+        }
+        auto trans = loc.Transformation();
+        for (int i = 1; i <= mesh->NbNodes(); i ++) {
+            auto p = mesh->Node(i).Transformed(trans);
+            float v[3] = { (float) p.X(), (float) p.Y(), (float) p.Z() };
+            auto first = ret.nodes == 0 && i == 1;
+            for (int d = 0; d < 3; d ++) {
+                ret.min[d] = first ? v[d] : std::min(ret.min[d], v[d]);
+                ret.max[d] = first ? v[d] : std::max(ret.max[d], v[d]);
+            }
+        }
+        ret.nodes += mesh->NbNodes();
+        ret.triangles += mesh->NbTriangles();
+    }
+    return ret;
+}
+
+// the layout is fixed by the counts, so a mesh that came out different is cut or padded to it
+template <typename T>
+void WriteArray(ExportSink &sink, const std::vector<T> &arr, size_t count) {
+    auto size = std::min(arr.size(), count);
+    sink.Write(arr.data(), size * sizeof(T));
+    if (count > size) {
+        sink.Pad((count - size) * sizeof(T));
+    }
+}
+
+std::string EscapeJson(const std::string &str) {
+    std::ostringstream ret;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            ret << '\\' << c;
+        } else if ((unsigned char) c < 0x20) {
+            ret << ' ';
+        } else {
+            ret << c;
+        }
+    }
+    return ret.str();
+}
+
+// meshing is the slow part and is done before anything is written. The triangulation stays on the faces,
+// so the counts come from it and `BuildMesh` later only extracts it, one shape at a time
+bool MeshShapes(const Napi::CallbackInfo &info, const std::vector<TopoDS_Shape> &shapes,
+        const IMeshTools_Parameters &params, std::vector<MeshStats> &stats) {
+    auto progress = GetProgress(info, 2);
+    Message_ProgressScope scope(progress->Start(), "export", (Standard_Real) shapes.size());
+    for (size_t i = 0; i < shapes.size() && scope.More(); i ++) {
+        BRepMesh_IncrementalMesh mesher(shapes[i], params, scope.Next());
+        stats.push_back(CountMesh(shapes[i]));
+    }
+    return !ThrowIfStopped(info.Env(), progress, "export");
+}
+
+std::vector<TopoDS_Shape> GetExportShapes(const Napi::CallbackInfo &info) {
+    std::vector<TopoDS_Shape> shapes;
+    auto list = info[0].As<Napi::Array>();
+    for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+        shapes.push_back(Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape);
+    }
+    return shapes;
+}
+
+// one scene node per shape, with a child node holding the mesh, names and colors are from the step metadata
+Napi::Value ExportGlb(const Napi::CallbackInfo &info) {
+    auto shapes = GetExportShapes(info);
+    auto params = GetMeshParams(info, 2);
+    auto optimize = GetMeshOptimize(info, 2);
+    std::vector<MeshStats> stats;
+    if (!MeshShapes(info, shapes, params, stats)) {
+        return info.Env().Undefined();
+    }
+    ExportSink sink(info, 1);
+    if (!sink.IsOpen()) {
+        auto msg = std::string("failed to write ") + sink.file;
+        Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    std::ostringstream nodes, meshes, accessors, views, materials;
+    std::map<std::string, int> colors;
+    size_t offset = 0;
+    int meshNum = 0;
+    nodes.precision(9);
+    accessors.precision(9);
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        std::map<std::string, std::string> meta;
+        {
+            std::lock_guard<std::mutex> lock(Shape::MetaMutex);
+            auto found = Shape::MetaMap.find(shapes[i].HashCode(0x0fffffff));
+            if (found != Shape::MetaMap.end()) {
+                meta = found->second;
+            }
+        }
+        auto &stat = stats[i];
+        nodes << (i ? "," : "") << "{\"name\":\"" << EscapeJson(meta["ManifoldSolidBrep"]) << "\"";
+        if (stat.triangles) {
+            auto child = shapes.size() + meshNum;
+            nodes << ",\"children\":[" << child << "]";
+        }
+        nodes << "}";
+        if (!stat.triangles) {
+            continue;
+        }
+
+        auto acc = meshNum * 3;
+        meshes << (meshNum ? "," : "") << "{\"primitives\":[{\"attributes\":{\"POSITION\":" << acc << ",\"NORMAL\":" << acc + 1 << "},"
+            << "\"indices\":" << acc + 2 << ",\"mode\":4";
+        auto &color = meta["ColorRGB"];
+        if (!color.empty()) {
+            if (!colors.count(color)) {
+                auto idx = (int) colors.size();
+                materials << (idx ? "," : "") << "{\"pbrMetallicRoughness\":{\"baseColorFactor\":[" << color << ",1]}}";
+                colors[color] = idx;
+            }
+            meshes << ",\"material\":" << colors[color];
+        }
+        meshes << "}]}";
+
+        size_t sizes[3] = { stat.nodes * 12, stat.nodes * 12, stat.triangles * 12 };
+        for (int k = 0; k < 3; k ++) {
+            views << (acc + k ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << offset << ",\"byteLength\":" << sizes[k]
+                << ",\"target\":" << (k < 2 ? 34962 : 34963) << "}";
+            offset += sizes[k];
+        }
+        accessors << (acc ? "," : "")
+            << "{\"bufferView\":" << acc << ",\"componentType\":5126,\"count\":" << stat.nodes << ",\"type\":\"VEC3\","
+            << "\"min\":[" << stat.min[0] << "," << stat.min[1] << "," << stat.min[2] << "],"
+            << "\"max\":[" << stat.max[0] << "," << stat.max[1] << "," << stat.max[2] << "]},"
+            << "{\"bufferView\":" << acc + 1 << ",\"componentType\":5126,\"count\":" << stat.nodes << ",\"type\":\"VEC3\"},"
+            << "{\"bufferView\":" << acc + 2 << ",\"componentType\":5125,\"count\":" << stat.triangles * 3 << ",\"type\":\"SCALAR\"}";
+        meshNum ++;
+    }
+    for (int i = 0; i < meshNum; i ++) {
+        nodes << ",{\"mesh\":" << i << "}";
+    }
+
+    std::ostringstream json;
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"@ttk/occ\"},\"scene\":0,\"scenes\":[{\"nodes\":[";
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        json << (i ? "," : "") << i;
+    }
+    json << "]}],\"nodes\":[" << nodes.str() << "]";
+    if (meshNum) {
+        json << ",\"meshes\":[" << meshes.str() << "]"
+            << ",\"accessors\":[" << accessors.str() << "]"
+            << ",\"bufferViews\":[" << views.str() << "]"
+            << ",\"buffers\":[{\"byteLength\":" << offset << "}]";
+    }
+    if (colors.size()) {
+        json << ",\"materials\":[" << materials.str() << "]";
+    }
+    json << "}";
+
+    auto str = json.str();
+    auto jsonPad = (4 - str.size() % 4) % 4;
+    uint32_t jsonLength = (uint32_t) (str.size() + jsonPad), binLength = (uint32_t) offset;
+    uint32_t header[3] = { 0x46546C67, 2, (uint32_t) (12 + 8 + jsonLength + (offset ? 8 + binLength : 0)) };
+    sink.Begin(header[2]);
+    sink.Write(header, sizeof(header));
+    uint32_t jsonHeader[2] = { jsonLength, 0x4E4F534A };
+    sink.Write(jsonHeader, sizeof(jsonHeader));
+    sink.Write(str.data(), str.size());
+    sink.Pad(jsonPad, ' ');
+    if (offset) {
+        uint32_t binHeader[2] = { binLength, 0x004E4942 };
+        sink.Write(binHeader, sizeof(binHeader));
+        // only one shape is held in memory at a time
+        for (size_t i = 0; i < shapes.size(); i ++) {
+            auto &stat = stats[i];
+            if (stat.triangles) {
+                auto mesh = BuildMesh(shapes[i], params);
+                if (optimize) {
+                    OptimizeMesh(mesh);
+                }
+                WriteArray(sink, mesh.positions, stat.nodes * 3);
+                WriteArray(sink, mesh.normals, stat.nodes * 3);
+                WriteArray(sink, mesh.indices, stat.triangles * 3);
+            }
+        }
+    }
+    return sink.Finish();
+}
+
+Napi::Value ExportStl(const Napi::CallbackInfo &info) {
+    auto shapes = GetExportShapes(info);
+    auto params = GetMeshParams(info, 2);
+    std::vector<MeshStats> stats;
+    if (!MeshShapes(info, shapes, params, stats)) {
+        return info.Env().Undefined();
+    }
+    ExportSink sink(info, 1);
+    if (!sink.IsOpen()) {
+        auto msg = std::string("failed to write ") + sink.file;
+        Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    uint32_t total = 0;
+    for (auto &stat : stats) {
+        total += (uint32_t) stat.triangles;
+    }
+
+    sink.Begin(84 + (size_t) total * 50);
+    char header[80] = "binary stl by @ttk/occ";
+    sink.Write(header, sizeof(header));
+    sink.Write(&total, sizeof(total));
+    std::vector<char> chunk;
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        if (!stats[i].triangles) {
+            continue;
+        }
+        auto mesh = BuildMesh(shapes[i], params);
+        auto &pos = mesh.positions;
+        auto &idx = mesh.indices;
+        auto num = std::min(idx.size() / 3, stats[i].triangles);
+        chunk.resize(num * 50);
+        for (size_t t = 0; t < num; t ++) {
+            float data[12];
+            for (int v = 0; v < 3; v ++) {
+                std::copy(&pos[idx[t * 3 + v] * 3], &pos[idx[t * 3 + v] * 3] + 3, &data[3 + v * 3]);
+            }
+            auto a = gp_Vec(data[6] - data[3], data[7] - data[4], data[8] - data[5]),
+                b = gp_Vec(data[9] - data[3], data[10] - data[4], data[11] - data[5]),
+                n = a.Crossed(b);
+            if (n.Magnitude() > gp::Resolution()) {
+                n.Normalize();
+            }
+            data[0] = (float) n.X();
+            data[1] = (float) n.Y();
+            data[2] = (float) n.Z();
+            memcpy(&chunk[t * 50], data, sizeof(data));
+            chunk[t * 50 + 48] = chunk[t * 50 + 49] = 0;
+        }
+        sink.Write(chunk.data(), chunk.size());
+        if (stats[i].triangles > num) {
+            sink.Pad((stats[i].triangles - num) * 50);
+        }
+    }
+    return sink.Finish();
+}
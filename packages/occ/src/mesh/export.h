@@ -0,0 +1,4 @@
+#include <napi.h>
+
+Napi::Value ExportGlb(const Napi::CallbackInfo &info);
+Napi::Value ExportStl(const Napi::CallbackInfo &info);
@@ -1,13 +1,28 @@
 #include "mesh.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Vertex.hxx>
+#include <Standard_Failure.hxx>
+#include <OSD_Parallel.hxx>
 
 #include "../topo/shape.h"
+#include "../progress.h"
 
 using std::map;
 using std::vector;
@@ -26,7 +41,7 @@ auto inline roundBy(double3 p, double e) {
 }
 
 template <typename T>
-auto getPos(T pos, int idx) {
+auto getPos(const T &pos, int idx) {
     auto n = idx * 3;
     return gp_XYZ(pos[n], pos[n + 1], pos[n + 2]);
 }
@@ -41,26 +56,123 @@ auto getNorm(gp_XYZ p1, gp_XYZ p2, gp_XYZ p3) {
     return n;
 }
 
-Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
-    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
-    IMeshTools_Parameters params;
-    if (info.Length() > 1) {
-        auto opts = info[1].As<Napi::Object>();
-        params.Angle = opts.Has("angle") ? opts.Get("angle").As<Napi::Number>().DoubleValue() : 0.5;
-        params.Deflection = opts.Has("deflection") ? opts.Get("deflection").As<Napi::Number>().DoubleValue() : 0.1;
+Napi::Object CsrToObject(Napi::Env env, const vector<uint32_t> &offsets, const vector<uint32_t> &indices) {
+    auto ret = Napi::Object::New(env);
+    auto off = Napi::Uint32Array::New(env, offsets.size());
+    std::copy(offsets.begin(), offsets.end(), off.Data());
+    ret.Set("offsets", off);
+    auto idx = Napi::Uint32Array::New(env, indices.size());
+    std::copy(indices.begin(), indices.end(), idx.Data());
+    ret.Set("indices", idx);
+    return ret;
+}
+
+// compressed rows of face -> edges, edge -> faces and edge -> verts,
+// all indexed like `shape.find(FACE/EDGE/VERTEX)`
+Napi::Object GetAdjacency(Napi::Env env, const TopoDS_Shape &shape,
+        const TopTools_IndexedMapOfShape &faceMap, const TopTools_IndexedMapOfShape &edgeMap) {
+    TopTools_IndexedMapOfShape vertMap;
+    TopExp::MapShapes(shape, TopAbs_VERTEX, vertMap);
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+
+    vector<uint32_t> efOffsets { 0 }, efIndices, evOffsets { 0 }, evIndices;
+    vector<uint32_t> faceCount(faceMap.Extent() + 1, 0);
+    for (int i = 1; i <= edgeMap.Extent(); i ++) {
+        auto &edge = edgeMap(i);
+        auto start = efIndices.size();
+        if (auto list = edgeFaces.Seek(edge)) {
+            for (auto &face : *list) {
+                auto idx = faceMap.FindIndex(face) - 1;
+                // seam edges are listed twice by the same face
+                if (idx >= 0 && std::find(efIndices.begin() + start, efIndices.end(), (uint32_t) idx) == efIndices.end()) {
+                    efIndices.push_back(idx);
+                    faceCount[idx + 1] ++;
+                }
+            }
+        }
+        efOffsets.push_back((uint32_t) efIndices.size());
+
+        TopoDS_Vertex v1, v2;
+        TopExp::Vertices(TopoDS::Edge(edge), v1, v2);
+        if (!v1.IsNull()) {
+            evIndices.push_back(vertMap.FindIndex(v1) - 1);
+        }
+        if (!v2.IsNull() && !v2.IsSame(v1)) {
+            evIndices.push_back(vertMap.FindIndex(v2) - 1);
+        }
+        evOffsets.push_back((uint32_t) evIndices.size());
     }
 
-    BRepMesh_IncrementalMesh mesher(shape, params);
+    // face -> edges is the transpose of edge -> faces
+    vector<uint32_t> feOffsets(faceCount.size(), 0), feIndices(efIndices.size());
+    for (size_t i = 1; i < faceCount.size(); i ++) {
+        feOffsets[i] = feOffsets[i - 1] + faceCount[i];
+    }
+    vector<uint32_t> cursor(feOffsets.begin(), feOffsets.end() - 1);
+    for (size_t e = 0; e + 1 < efOffsets.size(); e ++) {
+        for (auto k = efOffsets[e]; k < efOffsets[e + 1]; k ++) {
+            feIndices[cursor[efIndices[k]] ++] = (uint32_t) e;
+        }
+    }
+
+    auto verts = Napi::Float64Array::New(env, vertMap.Extent() * 3);
+    for (int i = 1; i <= vertMap.Extent(); i ++) {
+        auto pt = BRep_Tool::Pnt(TopoDS::Vertex(vertMap(i)));
+        verts[(i - 1) * 3    ] = pt.X();
+        verts[(i - 1) * 3 + 1] = pt.Y();
+        verts[(i - 1) * 3 + 2] = pt.Z();
+    }
+
+    auto ret = Napi::Object::New(env);
+    ret.Set("faceEdges", CsrToObject(env, feOffsets, feIndices));
+    ret.Set("edgeFaces", CsrToObject(env, efOffsets, efIndices));
+    ret.Set("edgeVerts", CsrToObject(env, evOffsets, evIndices));
+    ret.Set("verts", verts);
+    return ret;
+}
+
+Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
+    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    auto params = GetMeshParams(info, 1);
 
     TopLoc_Location loc;
     shape.Location(loc);
+
+    // with `faces`, only these faces (indices of shape.find(FACE)) are meshed and returned.
+    // after a boolean, faces unchanged in its history can keep their old meshes
+    TopTools_IndexedMapOfShape faceMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    TopTools_IndexedMapOfShape edgeMap;
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    auto target = shape;
+    if (info.Length() > 1 && info[1].IsObject() && info[1].As<Napi::Object>().Has("faces")) {
+        auto list = info[1].As<Napi::Object>().Get("faces").As<Napi::Array>();
+        TopoDS_Compound comp;
+        BRep_Builder builder;
+        builder.MakeCompound(comp);
+        for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+            auto idx = list.Get(i).As<Napi::Number>().Int32Value();
+            if (idx >= 0 && idx < faceMap.Extent()) {
+                builder.Add(comp, faceMap(idx + 1));
+            }
+        }
+        target = comp;
+    }
+
+    auto progress = GetProgress(info, 1);
+    BRepMesh_IncrementalMesh mesher(target, params, progress->Start());
+    if (ThrowIfStopped(info.Env(), progress, "mesh")) {
+        return info.Env().Undefined();
+    }
+
     auto isId = loc.IsIdentity();
     auto trans = loc.Transformation();
     int faceIndex = 0;
     std::vector<float> positions, normals;
     std::vector<int> indices;
     auto faces = Napi::Array::New(info.Env());
-    for (TopExp_Explorer ex(shape, TopAbs_ShapeEnum::TopAbs_FACE); ex.More(); ex.Next()) {
+    for (TopExp_Explorer ex(target, TopAbs_ShapeEnum::TopAbs_FACE); ex.More(); ex.Next()) {
         auto face = TopoDS::Face(ex.Current());
         auto mesh = BRep_Tool::Triangulation(face, loc);
         if (!mesh) {
@@ -122,6 +234,7 @@ Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
         ret.Set("positions", pos);
         ret.Set("indices", idx);
         ret.Set("normals", norm);
+        ret.Set("index", faceMap.FindIndex(face) - 1);
         faces.Set(faceIndex ++, ret);
     }
 
@@ -138,7 +251,7 @@ Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
 
     auto edgeIndex = 0;
     auto edges = Napi::Array::New(info.Env());
-    for (TopExp_Explorer ex(shape, TopAbs_ShapeEnum::TopAbs_EDGE); ex.More(); ex.Next()) {
+    for (TopExp_Explorer ex(target, TopAbs_ShapeEnum::TopAbs_EDGE); ex.More(); ex.Next()) {
         auto edge = TopoDS::Edge(ex.Current());
         BRepMesh_IncrementalMesh mesher(edge, params);
         auto mesh = BRep_Tool::Polygon3D(edge, loc);
@@ -153,13 +266,14 @@ Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
             }
             auto ret = Napi::Object::New(info.Env());
             ret.Set("positions", pos);
+            ret.Set("index", edgeMap.FindIndex(edge) - 1);
             edges.Set(edgeIndex ++, ret);
         }
     }
 
     auto vertIndex = 0;
     auto verts = Napi::Array::New(info.Env());
-    for (TopExp_Explorer ex(shape, TopAbs_ShapeEnum::TopAbs_VERTEX); ex.More(); ex.Next()) {
+    for (TopExp_Explorer ex(target, TopAbs_ShapeEnum::TopAbs_VERTEX); ex.More(); ex.Next()) {
         auto vert = TopoDS::Vertex(ex.Current());
         auto pt = BRep_Tool::Pnt(vert);
         auto pos = Napi::Array::New(info.Env());
@@ -176,46 +290,64 @@ Napi::Value CreateTopo(const Napi::CallbackInfo &info) {
     ret.Set("edges", edges);
     ret.Set("verts", verts);
     ret.Set("geom", geom);
+    ret.Set("adjacency", GetAdjacency(info.Env(), shape, faceMap, edgeMap));
     return ret;
 }
 
-// https://github.com/FreeCAD/FreeCAD/blob/a4fa45b589ffd896d1a5c3a16c902c81e0ab1a27/src/Mod/PartDesign/Gui/ViewProviderAddSub.cpp
-Napi::Value CreateMesh(const Napi::CallbackInfo &info) {
-    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+bool GetMeshOptimize(const Napi::CallbackInfo &info, size_t idx) {
+    if (info.Length() > idx && info[idx].IsObject()) {
+        auto opts = info[idx].As<Napi::Object>();
+        return opts.Has("optimize") && opts.Get("optimize").ToBoolean().Value();
+    }
+    return false;
+}
+
+IMeshTools_Parameters GetMeshParams(const Napi::CallbackInfo &info, size_t idx) {
     IMeshTools_Parameters params;
-    if (info.Length() > 1) {
-        auto opts = info[1].As<Napi::Object>();
+    if (info.Length() > idx && info[idx].IsObject()) {
+        auto opts = info[idx].As<Napi::Object>();
         params.Angle = opts.Has("angle") ? opts.Get("angle").As<Napi::Number>().DoubleValue() : 0.5;
         params.Deflection = opts.Has("deflection") ? opts.Get("deflection").As<Napi::Number>().DoubleValue() : 0.1;
     }
-    BRepMesh_IncrementalMesh mesher(shape, params);
+    return params;
+}
+
+// https://github.com/FreeCAD/FreeCAD/blob/a4fa45b589ffd896d1a5c3a16c902c81e0ab1a27/src/Mod/PartDesign/Gui/ViewProviderAddSub.cpp
+// no js values are touched here, so it is safe to call from worker threads
+MeshData BuildMesh(const TopoDS_Shape &shape, const IMeshTools_Parameters &params, const Message_ProgressRange &range) {
+    BRepMesh_IncrementalMesh mesher(shape, params, range);
 
     TopLoc_Location loc;
-    shape.Location(loc);
-    int posNum = 0, idxNum = 0;
+    size_t posNum = 0, idxNum = 0;
     for (TopExp_Explorer ex(shape, TopAbs_ShapeEnum::TopAbs_FACE); ex.More(); ex.Next()) {
         auto mesh = BRep_Tool::Triangulation(TopoDS::Face(ex.Current()), loc);
-        posNum += mesh->NbNodes();
-        idxNum += mesh->NbTriangles();
+        if (mesh) {
+            posNum += mesh->NbNodes();
+            idxNum += mesh->NbTriangles();
+        }
     }
 
-    auto pos = Napi::Float32Array::New(info.Env(), posNum * 3);
-    auto idx = Napi::Uint32Array::New(info.Env(), idxNum * 3);
-    auto norm = Napi::Float32Array::New(info.Env(), posNum * 3);
-    auto groups = Napi::Uint32Array::New(info.Env(), idxNum * 3);
+    MeshData ret;
+    auto &pos = ret.positions, &norm = ret.normals;
+    auto &idx = ret.indices, &groups = ret.groups;
+    pos.resize(posNum * 3);
+    norm.resize(posNum * 3);
+    idx.resize(idxNum * 3);
+    groups.resize(idxNum * 3);
     std::vector<int> normNum(posNum * 3);
 
     posNum = idxNum = 0;
-    shape.Location(loc);
-    auto isId = loc.IsIdentity();
-    auto trans = loc.Transformation();
-
-    int groupIdx = 0;
+    uint32_t groupIdx = 0;
     for (TopExp_Explorer ex(shape, TopAbs_ShapeEnum::TopAbs_FACE); ex.More(); ex.Next(), groupIdx ++) {
         auto face = TopoDS::Face(ex.Current());
         auto mesh = BRep_Tool::Triangulation(face, loc);
+        if (!mesh) {
+            continue;
+        }
+        auto isId = loc.IsIdentity();
+        auto trans = loc.Transformation();
         auto orient = face.Orientation();
-        auto start = posNum;
+        auto start = (uint32_t) posNum;
         for (int i = 0, n = mesh->NbNodes(); i < n; i ++, posNum ++) {
             auto s = posNum * 3;
             auto p = mesh->Node(i + 1);
@@ -242,7 +374,7 @@ Napi::Value CreateMesh(const Napi::CallbackInfo &info) {
                 getPos(pos, idx[s]),
                 getPos(pos, idx[s + 1]),
                 getPos(pos, idx[s + 2]));
-            for (int d = s; d < s + 3; d ++) {
+            for (auto d = s; d < s + 3; d ++) {
                 int q = idx[d] * 3,
                     c = normNum[q];
                 normNum[q] ++;
@@ -255,8 +387,150 @@ Napi::Value CreateMesh(const Napi::CallbackInfo &info) {
             }
         }
     }
+    return ret;
+}
+
+// triangle order of one face group for the post transform cache, after Tipsify (Sander et al. 2007).
+// `idx` holds local vertex indices below `vertNum`, the reordered triangles are appended to `out`
+void TipsifyGroup(const uint32_t *idx, size_t triNum, size_t vertNum, uint32_t cacheSize, vector<uint32_t> &out) {
+    vector<uint32_t> offsets(vertNum + 1, 0), adjacent(triNum * 3), live(vertNum, 0);
+    for (size_t i = 0; i < triNum * 3; i ++) {
+        offsets[idx[i] + 1] ++;
+        live[idx[i]] ++;
+    }
+    for (size_t v = 0; v < vertNum; v ++) {
+        offsets[v + 1] += offsets[v];
+    }
+    vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triNum * 3; i ++) {
+        adjacent[cursor[idx[i]] ++] = (uint32_t) (i / 3);
+    }
+
+    vector<uint32_t> cacheTime(vertNum, 0), deadEnd, candidates;
+    vector<bool> emitted(triNum, false);
+    uint32_t time = cacheSize + 1;
+    size_t scan = 0;
+    int64_t fan = triNum ? idx[0] : -1;
+    while (fan >= 0) {
+        candidates.clear();
+        for (auto k = offsets[fan]; k < offsets[fan + 1]; k ++) {
+            auto t = adjacent[k];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (int d = 0; d < 3; d ++) {
+                auto v = idx[t * 3 + d];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v] --;
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time ++;
+                }
+            }
+        }
+
+        // prefer the candidate that is still in cache and oldest, so its fan is emitted before it falls out
+        fan = -1;
+        int64_t best = -1;
+        for (auto v : candidates) {
+            if (live[v] > 0) {
+                int64_t priority = 0;
+                if (time - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > best) {
+                    best = priority;
+                    fan = v;
+                }
+            }
+        }
+        while (fan < 0 && !deadEnd.empty()) {
+            auto v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) {
+                fan = v;
+            }
+        }
+        while (fan < 0 && scan < vertNum) {
+            if (live[scan] > 0) {
+                fan = scan;
+            }
+            scan ++;
+        }
+    }
+}
 
-    auto ret = Napi::Object::New(info.Env());
+// reorders the triangles of every face group for the vertex cache,
+// then renumbers the vertices by first use so they are fetched in order
+void OptimizeMesh(MeshData &data) {
+    auto &idx = data.indices;
+    auto &groups = data.groups;
+    auto triNum = idx.size() / 3;
+    auto vertNum = data.positions.size() / 3;
+    const uint32_t unused = ~0u;
+    // vertices of a group are numbered locally, as groups of obj files share one vertex pool
+    // and a range of global indices would make every group as large as the whole pool
+    vector<uint32_t> ordered, local, localOf(vertNum, unused), globalOf;
+    ordered.reserve(idx.size());
+    for (size_t t0 = 0, t1 = 0; t0 < triNum; t0 = t1) {
+        auto group = groups.size() ? groups[t0 * 3] : 0;
+        for (t1 = t0; t1 < triNum && (groups.empty() || groups[t1 * 3] == group); t1 ++);
+        local.resize((t1 - t0) * 3);
+        globalOf.clear();
+        for (size_t i = 0; i < local.size(); i ++) {
+            auto v = idx[t0 * 3 + i];
+            if (localOf[v] == unused) {
+                localOf[v] = (uint32_t) globalOf.size();
+                globalOf.push_back(v);
+            }
+            local[i] = localOf[v];
+        }
+        auto start = ordered.size();
+        TipsifyGroup(local.data(), t1 - t0, globalOf.size(), 16, ordered);
+        for (auto i = start; i < ordered.size(); i ++) {
+            ordered[i] = globalOf[ordered[i]];
+        }
+        for (auto v : globalOf) {
+            localOf[v] = unused;
+        }
+    }
+
+    vector<uint32_t> remap(vertNum, unused);
+    uint32_t next = 0;
+    for (auto &v : ordered) {
+        if (remap[v] == unused) {
+            remap[v] = next ++;
+        }
+        v = remap[v];
+    }
+    for (auto &v : remap) {
+        if (v == unused) {
+            v = next ++;
+        }
+    }
+    vector<float> positions(data.positions.size()), normals(data.normals.size());
+    for (size_t v = 0; v < vertNum; v ++) {
+        std::copy(&data.positions[v * 3], &data.positions[v * 3] + 3, &positions[remap[v] * 3]);
+        std::copy(&data.normals[v * 3], &data.normals[v * 3] + 3, &normals[remap[v] * 3]);
+    }
+    data.positions.swap(positions);
+    data.normals.swap(normals);
+    idx.swap(ordered);
+}
+
+Napi::Object MeshToObject(Napi::Env env, const MeshData &data) {
+    auto pos = Napi::Float32Array::New(env, data.positions.size());
+    std::copy(data.positions.begin(), data.positions.end(), pos.Data());
+    auto idx = Napi::Uint32Array::New(env, data.indices.size());
+    std::copy(data.indices.begin(), data.indices.end(), idx.Data());
+    auto norm = Napi::Float32Array::New(env, data.normals.size());
+    std::copy(data.normals.begin(), data.normals.end(), norm.Data());
+    auto groups = Napi::Uint32Array::New(env, data.groups.size());
+    std::copy(data.groups.begin(), data.groups.end(), groups.Data());
+
+    auto ret = Napi::Object::New(env);
     ret.Set("positions", pos);
     ret.Set("indices", idx);
     ret.Set("normals", norm);
@@ -264,8 +538,302 @@ Napi::Value CreateMesh(const Napi::CallbackInfo &info) {
     return ret;
 }
 
+Napi::Value CreateMesh(const Napi::CallbackInfo &info) {
+    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    auto progress = GetProgress(info, 1);
+    auto data = BuildMesh(shape, GetMeshParams(info, 1), progress->Start());
+    if (ThrowIfStopped(info.Env(), progress, "mesh")) {
+        return info.Env().Undefined();
+    }
+    if (GetMeshOptimize(info, 1)) {
+        OptimizeMesh(data);
+    }
+    return MeshToObject(info.Env(), data);
+}
+
+// BRepMesh writes triangulations onto the faces and polygons onto the edges, so shapes sharing
+// any edge TShape (as the bodies of a general fuse do) are put in one group and meshed one at a time
+std::vector<size_t> GetMeshLockGroups(const std::vector<TopoDS_Shape> &shapes, size_t &groupNum) {
+    std::vector<size_t> parent(shapes.size());
+    for (size_t i = 0; i < parent.size(); i ++) {
+        parent[i] = i;
+    }
+    auto root = [&](size_t i) {
+        while (parent[i] != i) {
+            i = parent[i] = parent[parent[i]];
+        }
+        return i;
+    };
+    std::unordered_map<const TopoDS_TShape *, size_t> owners;
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        for (TopExp_Explorer ex(shapes[i], TopAbs_EDGE); ex.More(); ex.Next()) {
+            auto found = owners.emplace(ex.Current().TShape().get(), i).first;
+            parent[root(i)] = root(found->second);
+        }
+    }
+    std::vector<size_t> groups(shapes.size());
+    std::unordered_map<size_t, size_t> groupIdx;
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        groups[i] = groupIdx.emplace(root(i), groupIdx.size()).first->second;
+    }
+    groupNum = groupIdx.size();
+    return groups;
+}
+
+// solids sharing one TShape (and orientation) are meshed once in their own frame,
+// instance `i` is `shape.find(SOLID)[i]` drawn with prototype `prototypes[instances[i]]` and a column major 4x4 transform
+Napi::Value CreateInstances(const Napi::CallbackInfo &info) {
+    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    auto params = GetMeshParams(info, 1);
+
+    TopTools_IndexedMapOfShape solids;
+    TopExp::MapShapes(shape, TopAbs_SOLID, solids);
+    std::map<std::pair<const TopoDS_TShape *, int>, uint32_t> protoMap;
+    std::vector<TopoDS_Shape> protos;
+    auto protoIdx = Napi::Uint32Array::New(info.Env(), solids.Extent());
+    auto transforms = Napi::Float32Array::New(info.Env(), solids.Extent() * 16);
+    for (int i = 0; i < solids.Extent(); i ++) {
+        auto &solid = solids(i + 1);
+        auto key = std::make_pair(solid.TShape().get(), (int) solid.Orientation());
+        if (!protoMap.count(key)) {
+            protoMap[key] = (uint32_t) protos.size();
+            protos.push_back(solid.Located(TopLoc_Location()));
+        }
+        protoIdx[i] = protoMap[key];
+        auto trsf = solid.Location().Transformation();
+        auto mat = &transforms[i * 16];
+        for (int col = 0; col < 4; col ++) {
+            for (int row = 0; row < 3; row ++) {
+                mat[col * 4 + row] = (float) trsf.Value(row + 1, col + 1);
+            }
+            mat[col * 4 + 3] = col == 3 ? 1.f : 0.f;
+        }
+    }
+
+    // ranges are taken on this thread and filled by the workers
+    auto progress = GetProgress(info, 1);
+    Message_ProgressScope scope(progress->Start(), "instances", (Standard_Real) protos.size());
+    std::vector<Message_ProgressRange> ranges;
+    ranges.reserve(protos.size());
+    for (size_t i = 0; i < protos.size(); i ++) {
+        ranges.push_back(scope.Next());
+    }
+
+    size_t groupNum = 0;
+    auto groups = GetMeshLockGroups(protos, groupNum);
+    std::vector<std::mutex> locks(groupNum);
+    auto optimize = GetMeshOptimize(info, 1);
+    std::vector<MeshData> meshes(protos.size());
+    std::string error;
+    std::mutex errorMutex;
+    OSD_Parallel::For(0, (int) protos.size(), [&](int i) {
+        try {
+            std::lock_guard<std::mutex> lock(locks[groups[i]]);
+            meshes[i] = BuildMesh(protos[i], params, ranges[i]);
+            if (optimize) {
+                OptimizeMesh(meshes[i]);
+            }
+        } catch (Standard_Failure &err) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = std::string("mesh prototype ") + std::to_string(i) + " failed: " + err.GetMessageString();
+        }
+    });
+    if (ThrowIfStopped(info.Env(), progress, "mesh")) {
+        return info.Env().Undefined();
+    } else if (!error.empty()) {
+        Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    auto prototypes = Napi::Array::New(info.Env(), meshes.size());
+    for (size_t i = 0; i < meshes.size(); i ++) {
+        prototypes.Set((uint32_t) i, MeshToObject(info.Env(), meshes[i]));
+    }
+    auto ret = Napi::Object::New(info.Env());
+    ret.Set("prototypes", prototypes);
+    ret.Set("instances", protoIdx);
+    ret.Set("transforms", transforms);
+    return ret;
+}
+
+struct MeshBatch {
+    MeshBatch(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) { }
+    std::vector<TopoDS_Shape> shapes;
+    IMeshTools_Parameters params;
+    size_t concurrency = 1, budget = 0;
+    bool optimize = false;
+
+    // shapes sharing edges or faces must not be meshed at the same time, see GetMeshLockGroups
+    std::vector<size_t> groups;
+    std::vector<std::mutex> locks;
+    std::atomic<size_t> next { 0 };
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t pending = 0;
+    std::string error;
+
+    Handle(JsProgress) progress;
+    std::unique_ptr<Message_ProgressScope> scope;
+    std::vector<Message_ProgressRange> ranges;
+
+    Napi::ThreadSafeFunction tsfn;
+    Napi::Promise::Deferred deferred;
+    Napi::Reference<Napi::Array> results;
+    bool hasCallback = false;
+};
+
+void RunMeshBatch(std::shared_ptr<MeshBatch> job) {
+    for (auto i = job->next ++; i < job->shapes.size(); i = job->next ++) {
+        {
+            // results waiting for the js thread are counted against the memory budget
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->cond.wait(lock, [&] { return !job->budget || !job->pending || job->pending < job->budget; });
+            if (job->progress->UserBreak()) {
+                job->error = "mesh " + job->progress->Reason();
+                break;
+            }
+        }
+        auto &shape = job->shapes[i];
+        auto data = new MeshData();
+        auto failed = false;
+        try {
+            std::lock_guard<std::mutex> lock(job->locks[job->groups[i]]);
+            *data = BuildMesh(shape, job->params, job->ranges[i]);
+            if (job->optimize) {
+                OptimizeMesh(*data);
+            }
+        } catch (Standard_Failure &err) {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->error = std::string("mesh shape ") + std::to_string(i) + " failed: " + err.GetMessageString();
+            failed = true;
+        }
+        if (job->progress->UserBreak()) {
+            // a shape stopped halfway is not passed to js
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->error = "mesh " + job->progress->Reason();
+            delete data;
+            break;
+        } else if (failed) {
+            // the promise rejects with the error, an empty mesh is never passed on as a result
+            delete data;
+            continue;
+        }
+        auto size = data->ByteSize();
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->pending += size;
+        }
+        job->tsfn.BlockingCall(data, [job, i, size](Napi::Env env, Napi::Function callback, MeshData *data) {
+            try {
+                auto ret = MeshToObject(env, *data);
+                if (job->hasCallback) {
+                    callback.Call({ ret, Napi::Number::New(env, (double) i) });
+                } else {
+                    job->results.Value().Set((uint32_t) i, ret);
+                }
+            } catch (Napi::Error &err) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->error = err.Message();
+            }
+            delete data;
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->pending -= size;
+            }
+            job->cond.notify_all();
+        });
+    }
+}
+
+Napi::Value BatchMesh(const Napi::CallbackInfo &info) {
+    auto env = info.Env();
+    auto job = std::make_shared<MeshBatch>(env);
+    auto list = info[0].As<Napi::Array>();
+    for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+        auto &shape = Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape;
+        job->shapes.push_back(shape);
+    }
+    size_t groupNum = 0;
+    job->groups = GetMeshLockGroups(job->shapes, groupNum);
+    job->locks = std::vector<std::mutex>(groupNum);
+
+    job->concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+    auto callback = Napi::Function::New(env, [](const Napi::CallbackInfo &info) { });
+    job->params = GetMeshParams(info, 1);
+    job->optimize = GetMeshOptimize(info, 1);
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("concurrency")) {
+            job->concurrency = std::max(opts.Get("concurrency").As<Napi::Number>().Int32Value(), 1);
+        }
+        if (opts.Has("memoryBudget")) {
+            job->budget = (size_t) opts.Get("memoryBudget").As<Napi::Number>().Int64Value();
+        }
+        if (opts.Has("onMesh")) {
+            callback = opts.Get("onMesh").As<Napi::Function>();
+            job->hasCallback = true;
+        }
+    }
+    // with fewer shapes than threads, let BRepMesh split the faces of each shape instead
+    job->params.InParallel = job->shapes.size() < job->concurrency;
+    job->concurrency = std::min(job->concurrency, std::max(job->shapes.size(), (size_t) 1));
+    if (!job->hasCallback) {
+        job->results = Napi::Persistent(Napi::Array::New(env, job->shapes.size()));
+    }
+    job->progress = GetProgress(info, 1);
+    job->scope.reset(new Message_ProgressScope(job->progress->Start(), "batch", (Standard_Real) job->shapes.size()));
+    job->ranges.reserve(job->shapes.size());
+    for (size_t i = 0; i < job->shapes.size(); i ++) {
+        job->ranges.push_back(job->scope->Next());
+    }
+
+    job->tsfn = Napi::ThreadSafeFunction::New(env, callback, "MeshBatch", 0, 1);
+    // progress of the workers goes through the same queue as the meshes, all of it runs before the promise settles.
+    // a raw pointer, as the job owns the progress
+    auto batch = job.get();
+    job->progress->SetPost([batch](double fraction) {
+        batch->tsfn.NonBlockingCall(new double(fraction), [batch](Napi::Env env, Napi::Function callback, double *value) {
+            batch->progress->Notify(*value);
+            delete value;
+        });
+    });
+    std::thread([job] {
+        std::vector<std::thread> pool;
+        for (size_t i = 0; i < job->concurrency; i ++) {
+            pool.emplace_back(RunMeshBatch, job);
+        }
+        for (auto &thread : pool) {
+            thread.join();
+        }
+        job->tsfn.BlockingCall(job.get(), [job](Napi::Env env, Napi::Function callback, MeshBatch *) {
+            // the last fraction may have been skipped by the throttle
+            job->progress->Flush();
+            if (job->error.empty() && !job->progress->Reason().empty()) {
+                job->error = "mesh " + job->progress->Reason();
+            }
+            if (!job->error.empty()) {
+                job->deferred.Reject(Napi::Error::New(env, job->error).Value());
+            } else if (job->hasCallback) {
+                job->deferred.Resolve(Napi::Number::New(env, (double) job->shapes.size()));
+            } else {
+                job->deferred.Resolve(job->results.Value());
+            }
+            // references must be released on the js thread
+            job->results.Reset();
+            job->progress->Release();
+        });
+        job->tsfn.Release();
+    }).detach();
+
+    return job->deferred.Promise();
+}
+
 Napi::Value CreatePoly(const Napi::CallbackInfo &info) {
-    auto ret = CreateMesh(info).As<Napi::Object>();
+    auto val = CreateMesh(info);
+    if (!val.IsObject()) {
+        return val;
+    }
+    auto ret = val.As<Napi::Object>();
     auto pos = ret.Get("positions").As<Napi::Float32Array>();
     auto idx = ret.Get("indices").As<Napi::Uint32Array>();
     auto groups = ret.Get("groups").As<Napi::Uint32Array>();
@@ -1,6 +1,31 @@
+#pragma once
 #include <napi.h>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Message_ProgressRange.hxx>
+
+struct MeshData {
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices, groups;
+    size_t ByteSize() const {
+        return (positions.size() + normals.size() + indices.size() + groups.size()) * 4;
+    }
+};
+
+IMeshTools_Parameters GetMeshParams(const Napi::CallbackInfo &info, size_t idx);
+// `opts.optimize` of a js call
+bool GetMeshOptimize(const Napi::CallbackInfo &info, size_t idx);
+MeshData BuildMesh(const TopoDS_Shape &shape, const IMeshTools_Parameters &params, const Message_ProgressRange &range = Message_ProgressRange());
+// reorders triangles in every face group for the vertex cache and vertices by first use
+void OptimizeMesh(MeshData &data);
+// index of the lock group of every shape, shapes sharing edges or faces must not be meshed at the same time
+std::vector<size_t> GetMeshLockGroups(const std::vector<TopoDS_Shape> &shapes, size_t &groupNum);
+Napi::Object MeshToObject(Napi::Env env, const MeshData &data);
 
 Napi::Value CreateMesh(const Napi::CallbackInfo &info);
 Napi::Value CreateTopo(const Napi::CallbackInfo &info);
 Napi::Value CreatePoly(const Napi::CallbackInfo &info);
-
+Napi::Value BatchMesh(const Napi::CallbackInfo &info);
+Napi::Value CreateInstances(const Napi::CallbackInfo &info);
@@ -0,0 +1,245 @@
+#include "meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <OSD_Parallel.hxx>
+
+using std::vector;
+
+struct Meshlet {
+    uint32_t vertOffset, vertCount, triOffset, triCount, group;
+    float bounds[8];
+};
+
+struct MeshletList {
+    vector<uint32_t> verts;
+    vector<uint8_t> tris;
+    vector<Meshlet> meshlets;
+};
+
+// bounding sphere from the box center, and normal cone with the cutoff used as
+// `dot(center - camera, axis) >= cutoff * length(center - camera) + radius` for backface culling
+void SetMeshletBounds(const float *pos, const MeshletList &list, Meshlet &m) {
+    float min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+    for (uint32_t i = 0; i < m.vertCount; i ++) {
+        auto p = &pos[list.verts[m.vertOffset + i] * 3];
+        for (int d = 0; d < 3; d ++) {
+            min[d] = i ? std::min(min[d], p[d]) : p[d];
+            max[d] = i ? std::max(max[d], p[d]) : p[d];
+        }
+    }
+    float center[3] = { (min[0] + max[0]) / 2, (min[1] + max[1]) / 2, (min[2] + max[2]) / 2 }, radius = 0;
+    for (uint32_t i = 0; i < m.vertCount; i ++) {
+        auto p = &pos[list.verts[m.vertOffset + i] * 3];
+        auto dx = p[0] - center[0], dy = p[1] - center[1], dz = p[2] - center[2];
+        radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+
+    vector<float> normals;
+    float axis[3] = { 0, 0, 0 };
+    for (uint32_t t = 0; t < m.triCount; t ++) {
+        auto tri = &list.tris[m.triOffset + t * 3];
+        auto a = &pos[list.verts[m.vertOffset + tri[0]] * 3],
+            b = &pos[list.verts[m.vertOffset + tri[1]] * 3],
+            c = &pos[list.verts[m.vertOffset + tri[2]] * 3];
+        float u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] },
+            v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] },
+            n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+        auto len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len > 0) {
+            for (int d = 0; d < 3; d ++) {
+                normals.push_back(n[d] / len);
+                axis[d] += n[d] / len;
+            }
+        }
+    }
+    auto len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    float cutoff = 1;
+    if (len > 0) {
+        auto mindp = 1.f;
+        for (int d = 0; d < 3; d ++) {
+            axis[d] /= len;
+        }
+        for (size_t i = 0; i < normals.size(); i += 3) {
+            mindp = std::min(mindp, normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+        }
+        // normals spreading over a half space can not be culled
+        if (mindp > 0) {
+            cutoff = std::sqrt(1 - mindp * mindp);
+        }
+    }
+    if (cutoff >= 1) {
+        axis[0] = axis[1] = axis[2] = 0;
+    }
+
+    float bounds[8] = { center[0], center[1], center[2], radius, axis[0], axis[1], axis[2], cutoff };
+    std::copy(bounds, bounds + 8, m.bounds);
+}
+
+// greedy clustering of triangles [t0, t1) of one face group: grow from a seed,
+// preferring triangles that add the fewest new vertices and then the ones closest to the cluster
+void BuildMeshlets(const float *pos, const uint32_t *idx, size_t t0, size_t t1, uint32_t group,
+        size_t maxVerts, size_t maxTris, MeshletList &list) {
+    std::unordered_map<uint32_t, vector<uint32_t>> vertTris;
+    for (auto t = t0; t < t1; t ++) {
+        for (int k = 0; k < 3; k ++) {
+            vertTris[idx[t * 3 + k]].push_back((uint32_t) t);
+        }
+    }
+    vector<bool> used(t1 - t0, false);
+    std::unordered_map<uint32_t, uint8_t> local;
+    vector<uint32_t> candidates;
+    size_t seed = t0;
+    while (true) {
+        while (seed < t1 && used[seed - t0]) {
+            seed ++;
+        }
+        if (seed >= t1) {
+            break;
+        }
+
+        Meshlet m = { (uint32_t) list.verts.size(), 0, (uint32_t) list.tris.size(), 0, group };
+        float sum[3] = { 0, 0, 0 };
+        local.clear();
+        candidates.assign(1, (uint32_t) seed);
+        while (m.triCount < maxTris) {
+            int64_t best = -1;
+            int bestNew = 4;
+            float bestDist = 0;
+            for (auto t : candidates) {
+                if (used[t - t0]) {
+                    continue;
+                }
+                int added = 0;
+                float dist = 0;
+                for (int k = 0; k < 3; k ++) {
+                    auto v = idx[t * 3 + k];
+                    added += local.count(v) ? 0 : 1;
+                    if (m.vertCount) {
+                        for (int d = 0; d < 3; d ++) {
+                            auto diff = pos[v * 3 + d] - sum[d] / m.vertCount;
+                            dist += diff * diff;
+                        }
+                    }
+                }
+                if (added < bestNew || (added == bestNew && dist < bestDist)) {
+                    best = t;
+                    bestNew = added;
+                    bestDist = dist;
+                }
+            }
+            if (best < 0 || m.vertCount + bestNew > maxVerts) {
+                break;
+            }
+
+            used[best - t0] = true;
+            for (int k = 0; k < 3; k ++) {
+                auto v = idx[best * 3 + k];
+                if (!local.count(v)) {
+                    local[v] = (uint8_t) m.vertCount ++;
+                    list.verts.push_back(v);
+                    for (int d = 0; d < 3; d ++) {
+                        sum[d] += pos[v * 3 + d];
+                    }
+                    auto &tris = vertTris[v];
+                    candidates.insert(candidates.end(), tris.begin(), tris.end());
+                }
+                list.tris.push_back(local[v]);
+            }
+            m.triCount ++;
+        }
+        SetMeshletBounds(pos, list, m);
+        list.meshlets.push_back(m);
+    }
+}
+
+Napi::Value CreateMeshlets(const Napi::CallbackInfo &info) {
+    auto mesh = info[0].As<Napi::Object>();
+    auto positions = mesh.Get("positions").As<Napi::Float32Array>();
+    auto indices = mesh.Get("indices").As<Napi::Uint32Array>();
+    size_t maxVerts = 64, maxTris = 124;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("maxVerts")) {
+            maxVerts = opts.Get("maxVerts").As<Napi::Number>().Uint32Value();
+        }
+        if (opts.Has("maxTris")) {
+            maxTris = opts.Get("maxTris").As<Napi::Number>().Uint32Value();
+        }
+    }
+    // local indices are stored as bytes
+    maxVerts = std::min(std::max(maxVerts, (size_t) 3), (size_t) 256);
+    maxTris = std::max(maxTris, (size_t) 1);
+
+    auto pos = positions.Data();
+    auto idx = indices.Data();
+    auto triNum = indices.ElementLength() / 3;
+    for (size_t i = 0; i < triNum * 3; i ++) {
+        if (idx[i] * 3 + 2 >= positions.ElementLength()) {
+            Napi::Error::New(info.Env(), "mesh index out of range").ThrowAsJavaScriptException();
+            return info.Env().Undefined();
+        }
+    }
+
+    // runs of triangles in one face group, clusters never cross them
+    vector<size_t> starts;
+    vector<uint32_t> groupIds;
+    const uint32_t *groups = nullptr;
+    if (mesh.Has("groups")) {
+        auto arr = mesh.Get("groups").As<Napi::Uint32Array>();
+        if (arr.ElementLength() >= triNum * 3) {
+            groups = arr.Data();
+        }
+    }
+    for (size_t t = 0; t < triNum; t ++) {
+        auto group = groups ? groups[t * 3] : 0;
+        if (!t || group != groupIds.back()) {
+            starts.push_back(t);
+            groupIds.push_back(group);
+        }
+    }
+    starts.push_back(triNum);
+
+    vector<MeshletList> lists(groupIds.size());
+    OSD_Parallel::For(0, (int) groupIds.size(), [&](int i) {
+        BuildMeshlets(pos, idx, starts[i], starts[i + 1], groupIds[i], maxVerts, maxTris, lists[i]);
+    });
+
+    size_t vertNum = 0, triLen = 0, meshletNum = 0;
+    for (auto &list : lists) {
+        vertNum += list.verts.size();
+        triLen += list.tris.size();
+        meshletNum += list.meshlets.size();
+    }
+    auto env = info.Env();
+    auto verts = Napi::Uint32Array::New(env, vertNum);
+    auto tris = Napi::Uint8Array::New(env, triLen);
+    auto meshlets = Napi::Uint32Array::New(env, meshletNum * 4);
+    auto meshletGroups = Napi::Uint32Array::New(env, meshletNum);
+    auto bounds = Napi::Float32Array::New(env, meshletNum * 8);
+    size_t vertOffset = 0, triOffset = 0, m = 0;
+    for (auto &list : lists) {
+        std::copy(list.verts.begin(), list.verts.end(), verts.Data() + vertOffset);
+        std::copy(list.tris.begin(), list.tris.end(), tris.Data() + triOffset);
+        for (auto &item : list.meshlets) {
+            meshlets[m * 4    ] = (uint32_t) (item.vertOffset + vertOffset);
+            meshlets[m * 4 + 1] = item.vertCount;
+            meshlets[m * 4 + 2] = (uint32_t) (item.triOffset + triOffset);
+            meshlets[m * 4 + 3] = item.triCount;
+            meshletGroups[m] = item.group;
+            std::copy(item.bounds, item.bounds + 8, bounds.Data() + m * 8);
+            m ++;
+        }
+        vertOffset += list.verts.size();
+        triOffset += list.tris.size();
+    }
+
+    auto ret = Napi::Object::New(env);
+    ret.Set("meshlets", meshlets);
+    ret.Set("groups", meshletGroups);
+    ret.Set("vertices", verts);
+    ret.Set("triangles", tris);
+    ret.Set("bounds", bounds);
+    return ret;
+}
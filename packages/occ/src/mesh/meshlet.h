@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value CreateMeshlets(const Napi::CallbackInfo &info);
@@ -0,0 +1,533 @@
+#include "obj.h"
+#include "mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepLib.hxx>
+#include <BRep_Builder.hxx>
+#include <Geom_Plane.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD_Parallel.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <TColStd_Array1OfInteger.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Shell.hxx>
+#include <TopoDS_Solid.hxx>
+#include <TopoDS_Wire.hxx>
+
+#include "../topo/shape.h"
+#include "../progress.h"
+#include "../utils.h"
+
+using std::string;
+using std::vector;
+
+inline bool IsObjSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// the text is not null terminated, so numbers are parsed against `end`
+bool ParseObjInt(const char *&p, const char *end, long long &val) {
+    bool neg = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p ++;
+    }
+    auto start = p;
+    for (val = 0; p < end && *p >= '0' && *p <= '9'; p ++) {
+        val = val * 10 + (*p - '0');
+    }
+    val = neg ? -val : val;
+    return p > start;
+}
+
+bool ParseObjFloat(const char *&p, const char *end, double &val) {
+    static const double exact[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    bool neg = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p ++;
+    }
+    uint64_t mantissa = 0;
+    int exp = 0, digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p ++, digits ++) {
+        if (mantissa < 100000000000000000ull) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exp ++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p ++; p < end && *p >= '0' && *p <= '9'; p ++, digits ++) {
+            if (mantissa < 100000000000000000ull) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exp --;
+            }
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        auto q = p + 1;
+        long long e;
+        if (ParseObjInt(q, end, e)) {
+            exp += (int) std::max(-1000ll, std::min(e, 1000ll));
+            p = q;
+        }
+    }
+    val = (double) mantissa;
+    if (exp < 0) {
+        val = -exp <= 22 ? val / exact[-exp] : val * std::pow(10., exp);
+    } else if (exp > 0) {
+        val = exp <= 22 ? val * exact[exp] : val * std::pow(10., exp);
+    }
+    val = neg ? -val : val;
+    return true;
+}
+
+// `v`, `f`, `g` and `o` statements are read, the others are skipped
+char GetObjKeyword(const char *&p, const char *eol) {
+    while (p < eol && IsObjSpace(*p)) {
+        p ++;
+    }
+    if (p + 1 < eol && !IsObjSpace(p[1])) {
+        return 0;
+    }
+    auto key = p < eol ? *p : 0;
+    if (key == 'v' || key == 'f' || key == 'g' || key == 'o') {
+        p ++;
+        return key;
+    }
+    return 0;
+}
+
+// face vertex `v`, `v/vt`, `v//vn` or `v/vt/vn`, only the position index is kept
+bool NextObjFaceVertex(const char *&p, const char *eol, long long &idx) {
+    while (p < eol && IsObjSpace(*p)) {
+        p ++;
+    }
+    if (p >= eol || !ParseObjInt(p, eol, idx)) {
+        return false;
+    }
+    while (p < eol && !IsObjSpace(*p)) {
+        p ++;
+    }
+    return true;
+}
+
+struct ObjChunk {
+    const char *begin, *end;
+    // statements in the chunk and of all chunks before
+    size_t verts = 0, tris = 0, groups = 0;
+    size_t vertStart = 0, triStart = 0, groupStart = 0;
+    string error;
+};
+
+template <typename F>
+void ForEachObjLine(const char *p, const char *end, F fn) {
+    while (p < end) {
+        auto eol = (const char *) memchr(p, '\n', end - p);
+        eol = eol ? eol : end;
+        fn(p, eol);
+        p = eol + 1;
+    }
+}
+
+void CountObjChunk(ObjChunk &chunk) {
+    ForEachObjLine(chunk.begin, chunk.end, [&](const char *p, const char *eol) {
+        auto key = GetObjKeyword(p, eol);
+        if (key == 'v') {
+            chunk.verts ++;
+        } else if (key == 'g' || key == 'o') {
+            chunk.groups ++;
+        } else if (key == 'f') {
+            size_t num = 0;
+            for (long long idx; NextObjFaceVertex(p, eol, idx); num ++);
+            chunk.tris += num > 2 ? num - 2 : 0;
+        }
+    });
+}
+
+// polygons are split into fans, `groups` gets the number of `g` or `o` statements before every triangle
+void ParseObjChunk(ObjChunk &chunk, size_t vertNum, float *pos, uint32_t *idx, uint32_t *groups, string *names) {
+    size_t verts = chunk.vertStart, tris = chunk.triStart, group = chunk.groupStart;
+    vector<uint32_t> poly;
+    ForEachObjLine(chunk.begin, chunk.end, [&](const char *p, const char *eol) {
+        if (!chunk.error.empty()) {
+            return;
+        }
+        auto key = GetObjKeyword(p, eol);
+        if (key == 'v') {
+            double val;
+            for (int d = 0; d < 3; d ++) {
+                while (p < eol && IsObjSpace(*p)) {
+                    p ++;
+                }
+                if (!ParseObjFloat(p, eol, val)) {
+                    chunk.error = "invalid vertex #" + std::to_string(verts + 1);
+                    return;
+                }
+                pos[verts * 3 + d] = (float) val;
+            }
+            verts ++;
+        } else if (key == 'g' || key == 'o') {
+            while (p < eol && IsObjSpace(*p)) {
+                p ++;
+            }
+            auto q = eol;
+            while (q > p && IsObjSpace(q[-1])) {
+                q --;
+            }
+            names[++ group] = string(p, q);
+        } else if (key == 'f') {
+            poly.clear();
+            for (long long i; NextObjFaceVertex(p, eol, i); ) {
+                auto n = i > 0 ? i - 1 : (long long) verts + i;
+                if (i == 0 || n < 0 || n >= (long long) vertNum) {
+                    chunk.error = "face index " + std::to_string(i) + " out of range";
+                    return;
+                }
+                poly.push_back((uint32_t) n);
+            }
+            for (size_t i = 2; i < poly.size(); i ++, tris ++) {
+                idx[tris * 3    ] = poly[0];
+                idx[tris * 3 + 1] = poly[i - 1];
+                idx[tris * 3 + 2] = poly[i];
+                groups[tris] = (uint32_t) group;
+            }
+        }
+    });
+}
+
+// returns the error message, or an empty string on success
+string ParseObj(const char *data, size_t size, MeshData &mesh, vector<string> &names) {
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    auto chunkNum = std::max<size_t>(1, std::min<size_t>(size / 65536, threads * 4));
+    vector<ObjChunk> chunks(chunkNum);
+    for (size_t i = 0, start = 0; i < chunkNum; i ++) {
+        auto stop = i + 1 < chunkNum ? std::max(start, size * (i + 1) / chunkNum) : size;
+        auto eol = stop < size ? (const char *) memchr(data + stop, '\n', size - stop) : nullptr;
+        stop = eol ? eol - data + 1 : size;
+        chunks[i].begin = data + start;
+        chunks[i].end = data + stop;
+        start = stop;
+    }
+
+    OSD_Parallel::For(0, (int) chunkNum, [&](int i) { CountObjChunk(chunks[i]); });
+    size_t vertNum = 0, triNum = 0, groupNum = 0;
+    for (auto &chunk : chunks) {
+        chunk.vertStart = vertNum;
+        chunk.triStart = triNum;
+        chunk.groupStart = groupNum;
+        vertNum += chunk.verts;
+        triNum += chunk.tris;
+        groupNum += chunk.groups;
+    }
+    if (vertNum >= UINT32_MAX || triNum * 3 >= UINT32_MAX) {
+        return "too many vertices or faces";
+    }
+
+    vector<uint32_t> idx(triNum * 3), triGroups(triNum);
+    vector<string> groupNames(groupNum + 1);
+    mesh.positions.resize(vertNum * 3);
+    OSD_Parallel::For(0, (int) chunkNum, [&](int i) {
+        ParseObjChunk(chunks[i], vertNum, mesh.positions.data(), idx.data(), triGroups.data(), groupNames.data());
+    });
+    for (auto &chunk : chunks) {
+        if (!chunk.error.empty()) {
+            return chunk.error;
+        }
+    }
+
+    // groups of the same name are merged, and triangles are sorted by group like `mesh.create`
+    vector<size_t> groupTris(groupNum + 1, 0);
+    for (auto group : triGroups) {
+        groupTris[group] ++;
+    }
+    std::unordered_map<string, uint32_t> nameIdx;
+    vector<uint32_t> remap(groupNum + 1, 0);
+    for (size_t i = 0; i <= groupNum; i ++) {
+        if (groupTris[i]) {
+            auto found = nameIdx.find(groupNames[i]);
+            if (found == nameIdx.end()) {
+                found = nameIdx.emplace(groupNames[i], (uint32_t) names.size()).first;
+                names.push_back(groupNames[i]);
+            }
+            remap[i] = found->second;
+        }
+    }
+    vector<size_t> starts(names.size() + 1, 0);
+    for (size_t i = 0; i <= groupNum; i ++) {
+        if (groupTris[i]) {
+            starts[remap[i] + 1] += groupTris[i];
+        }
+    }
+    for (size_t i = 1; i < starts.size(); i ++) {
+        starts[i] += starts[i - 1];
+    }
+    mesh.indices.resize(triNum * 3);
+    mesh.groups.resize(triNum * 3);
+    for (size_t t = 0; t < triNum; t ++) {
+        auto group = remap[triGroups[t]];
+        auto s = starts[group] ++ * 3;
+        for (int d = 0; d < 3; d ++) {
+            mesh.indices[s + d] = idx[t * 3 + d];
+            mesh.groups[s + d] = group;
+        }
+    }
+
+    // obj normals are indexed apart from positions, so vertex normals are averaged from the faces instead
+    auto &pos = mesh.positions;
+    auto &norm = mesh.normals;
+    norm.assign(vertNum * 3, 0.f);
+    for (size_t s = 0; s < mesh.indices.size(); s += 3) {
+        auto a = &pos[mesh.indices[s] * 3], b = &pos[mesh.indices[s + 1] * 3], c = &pos[mesh.indices[s + 2] * 3];
+        auto n = gp_XYZ(b[0] - a[0], b[1] - a[1], b[2] - a[2]) ^ gp_XYZ(c[0] - b[0], c[1] - b[1], c[2] - b[2]);
+        auto m = n.Modulus();
+        if (m > gp::Resolution()) {
+            n.Divide(m);
+            for (int d = 0; d < 3; d ++) {
+                auto q = &norm[mesh.indices[s + d] * 3];
+                q[0] += (float) n.X();
+                q[1] += (float) n.Y();
+                q[2] += (float) n.Z();
+            }
+        }
+    }
+    for (size_t i = 0; i < vertNum; i ++) {
+        auto q = &norm[i * 3];
+        auto m = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
+        if (m > 0) {
+            q[0] /= m;
+            q[1] /= m;
+            q[2] /= m;
+        }
+    }
+    return "";
+}
+
+struct ObjVertKey {
+    float x, y, z;
+    bool operator==(const ObjVertKey &k) const {
+        return x == k.x && y == k.y && z == k.z;
+    }
+};
+
+struct ObjVertHash {
+    size_t operator()(const ObjVertKey &k) const {
+        auto h = std::hash<float>();
+        return h(k.x) ^ (h(k.y) * 0x9e3779b9) ^ (h(k.z) * 0x85ebca6b);
+    }
+};
+
+// every triangle becomes a planar face carrying its own one-triangle Poly_Triangulation, so the shape is meshed already.
+// faces share the vertices and edges of coincident positions, which is what sewing would give,
+// and every connected part closed with a consistent winding is made a solid
+TopoDS_Shape ObjToShape(const MeshData &mesh, const Message_ProgressRange &range) {
+    auto &pos = mesh.positions;
+    auto &idx = mesh.indices;
+    std::unordered_map<ObjVertKey, uint32_t, ObjVertHash> vertMap;
+    vector<uint32_t> weld(pos.size() / 3);
+    for (size_t i = 0; i < weld.size(); i ++) {
+        ObjVertKey key { pos[i * 3], pos[i * 3 + 1], pos[i * 3 + 2] };
+        weld[i] = vertMap.emplace(key, (uint32_t) vertMap.size()).first->second;
+    }
+
+    // edges are keyed by their welded vertices, `winding` counts the uses from the lower to the higher vertex
+    struct ObjEdge {
+        TopoDS_Edge edge;
+        int uses = 0, winding = 0;
+    };
+    std::unordered_map<uint64_t, uint32_t> edgeMap;
+    vector<ObjEdge> edges;
+    vector<uint32_t> tris, triEdges, parent;
+    for (size_t s = 0; s < idx.size(); s += 3) {
+        uint32_t v[3] = { weld[idx[s]], weld[idx[s + 1]], weld[idx[s + 2]] };
+        if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0]) {
+            continue;
+        }
+        // collinear triangles get no face, so their edges must not be counted for the closed check either
+        gp_Pnt p[3];
+        for (int d = 0; d < 3; d ++) {
+            p[d] = gp_Pnt(pos[idx[s + d] * 3], pos[idx[s + d] * 3 + 1], pos[idx[s + d] * 3 + 2]);
+        }
+        if ((gp_Vec(p[0], p[1]) ^ gp_Vec(p[1], p[2])).Magnitude() <= gp::Resolution()) {
+            continue;
+        }
+        for (int d = 0; d < 3; d ++) {
+            auto a = v[d], b = v[(d + 1) % 3];
+            auto key = ((uint64_t) std::min(a, b) << 32) | std::max(a, b);
+            auto found = edgeMap.emplace(key, (uint32_t) edges.size()).first;
+            if (found->second == edges.size()) {
+                edges.push_back(ObjEdge());
+            }
+            auto &edge = edges[found->second];
+            edge.uses ++;
+            edge.winding += a < b ? 1 : -1;
+            triEdges.push_back(found->second);
+        }
+        tris.push_back((uint32_t) s);
+    }
+
+    // connected parts by union find over shared edges
+    parent.resize(tris.size());
+    for (size_t i = 0; i < parent.size(); i ++) {
+        parent[i] = (uint32_t) i;
+    }
+    auto root = [&](uint32_t i) {
+        while (parent[i] != i) {
+            i = parent[i] = parent[parent[i]];
+        }
+        return i;
+    };
+    vector<int64_t> edgeTri(edges.size(), -1);
+    for (size_t t = 0; t < tris.size(); t ++) {
+        for (int d = 0; d < 3; d ++) {
+            auto &first = edgeTri[triEdges[t * 3 + d]];
+            if (first < 0) {
+                first = (int64_t) t;
+            } else {
+                parent[root((uint32_t) t)] = root((uint32_t) first);
+            }
+        }
+    }
+
+    BRep_Builder builder;
+    vector<TopoDS_Vertex> verts(vertMap.size());
+    auto getVert = [&](uint32_t i) -> const TopoDS_Vertex & {
+        if (verts[weld[i]].IsNull()) {
+            builder.MakeVertex(verts[weld[i]], gp_Pnt(pos[i * 3], pos[i * 3 + 1], pos[i * 3 + 2]), Precision::Confusion());
+        }
+        return verts[weld[i]];
+    };
+
+    std::map<uint32_t, TopoDS_Shell> shells;
+    std::map<uint32_t, bool> closed;
+    Message_ProgressScope scope(range, "faces", (Standard_Real) tris.size());
+    for (size_t t = 0; t < tris.size() && scope.More(); t ++, scope.Next()) {
+        auto s = tris[t];
+        gp_Pnt p[3];
+        for (int d = 0; d < 3; d ++) {
+            p[d] = gp_Pnt(pos[idx[s + d] * 3], pos[idx[s + d] * 3 + 1], pos[idx[s + d] * 3 + 2]);
+        }
+
+        Handle(Poly_Triangulation) tri = new Poly_Triangulation(3, 1, Standard_False);
+        for (int d = 0; d < 3; d ++) {
+            tri->SetNode(d + 1, p[d]);
+        }
+        tri->SetTriangle(1, Poly_Triangle(1, 2, 3));
+
+        TopoDS_Wire wire;
+        builder.MakeWire(wire);
+        for (int d = 0; d < 3; d ++) {
+            auto a = idx[s + d], b = idx[s + (d + 1) % 3];
+            auto &item = edges[triEdges[t * 3 + d]];
+            bool forward = weld[a] < weld[b];
+            if (item.edge.IsNull()) {
+                auto &va = getVert(forward ? a : b), &vb = getVert(forward ? b : a);
+                item.edge = BRepBuilderAPI_MakeEdge(va, vb).Edge();
+            }
+            TColStd_Array1OfInteger nodes(1, 2);
+            nodes(forward ? 1 : 2) = d + 1;
+            nodes(forward ? 2 : 1) = (d + 1) % 3 + 1;
+            builder.UpdateEdge(item.edge, new Poly_PolygonOnTriangulation(nodes), tri, TopLoc_Location());
+            builder.Add(wire, forward ? item.edge : TopoDS::Edge(item.edge.Reversed()));
+        }
+        wire.Closed(Standard_True);
+
+        TopoDS_Face face;
+        builder.MakeFace(face, new Geom_Plane(p[0], gp_Dir(gp_Vec(p[0], p[1]) ^ gp_Vec(p[1], p[2]))), Precision::Confusion());
+        builder.Add(face, wire);
+        builder.UpdateFace(face, tri);
+
+        auto part = root((uint32_t) t);
+        auto &shell = shells[part];
+        if (shell.IsNull()) {
+            builder.MakeShell(shell);
+            closed[part] = true;
+        }
+        builder.Add(shell, face);
+        for (int d = 0; d < 3; d ++) {
+            auto &item = edges[triEdges[t * 3 + d]];
+            if (item.uses != 2 || item.winding != 0) {
+                closed[part] = false;
+            }
+        }
+    }
+
+    TopoDS_Compound comp;
+    builder.MakeCompound(comp);
+    TopoDS_Shape last;
+    for (auto &pair : shells) {
+        auto &shell = pair.second;
+        if (closed[pair.first]) {
+            shell.Closed(Standard_True);
+            TopoDS_Solid solid;
+            builder.MakeSolid(solid);
+            builder.Add(solid, shell);
+            BRepLib::OrientClosedSolid(solid);
+            last = solid;
+        } else {
+            last = shell;
+        }
+        builder.Add(comp, last);
+    }
+    return shells.size() == 1 ? last : comp;
+}
+
+Napi::Value LoadObj(const Napi::CallbackInfo &info) {
+    auto env = info.Env();
+    MeshData mesh;
+    vector<string> names;
+    string error;
+    if (info[0].IsBuffer()) {
+        auto buf = info[0].As<Napi::Buffer<char>>();
+        error = ParseObj(buf.Data(), buf.Length(), mesh, names);
+    } else if (info[0].IsString()) {
+        std::string file = info[0].As<Napi::String>();
+        MappedFile mapped(file);
+        error = mapped.ok ? ParseObj(mapped.data, mapped.size, mesh, names) : "failed to read " + file;
+    } else {
+        error = "Only file name or buffer supported";
+    }
+    if (!error.empty()) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (GetMeshOptimize(info, 1)) {
+        OptimizeMesh(mesh);
+    }
+
+    auto ret = MeshToObject(env, mesh);
+    auto arr = Napi::Array::New(env, names.size());
+    for (size_t i = 0; i < names.size(); i ++) {
+        arr.Set(i, names[i]);
+    }
+    ret.Set("names", arr);
+
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("toShape") && opts.Get("toShape").ToBoolean().Value()) {
+            auto progress = GetProgress(info, 1);
+            auto shape = ObjToShape(mesh, progress->Start());
+            if (ThrowIfStopped(env, progress, "obj")) {
+                return env.Undefined();
+            }
+            ret.Set("shape", Shape::Create(env, shape));
+        }
+    }
+    return ret;
+}
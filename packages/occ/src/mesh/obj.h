@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value LoadObj(const Napi::CallbackInfo &info);
@@ -0,0 +1,113 @@
+#include "progress.h"
+
+enum ProgressState {
+    PROGRESS_RUNNING = 0,
+    PROGRESS_ABORTED = 1,
+    PROGRESS_TIMEOUT = 2,
+    PROGRESS_FAILED = 3,
+};
+
+JsProgress::JsProgress(Napi::Env env, Napi::Value val) : env(env), thread(std::this_thread::get_id()) {
+    if (!val.IsObject()) {
+        return;
+    }
+    auto opts = val.As<Napi::Object>();
+    if (opts.Has("signal") && opts.Get("signal").IsTypedArray()) {
+        auto arr = opts.Get("signal").As<Napi::Int32Array>();
+        if (arr.ElementLength() > 0) {
+            signalRef = Napi::Persistent(arr);
+            signal = reinterpret_cast<std::atomic<int32_t> *>(arr.Data());
+        }
+    }
+    if (opts.Has("timeoutMs")) {
+        auto ms = opts.Get("timeoutMs").As<Napi::Number>().Int64Value();
+        hasDeadline = true;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    }
+    if (opts.Has("onProgress")) {
+        callback = Napi::Persistent(opts.Get("onProgress").As<Napi::Function>());
+    }
+}
+
+Standard_Boolean JsProgress::UserBreak() {
+    if (state) {
+        return Standard_True;
+    }
+    if (signal && signal->load()) {
+        state = PROGRESS_ABORTED;
+    } else if (hasDeadline && std::chrono::steady_clock::now() > deadline) {
+        state = PROGRESS_TIMEOUT;
+    }
+    return state != PROGRESS_RUNNING;
+}
+
+// occt calls it under the indicator mutex, so only one thread is here at a time
+void JsProgress::Show(const Message_ProgressScope &scope, const Standard_Boolean isForce) {
+    if (callback.IsEmpty() || state) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (!isForce && now - lastShow < std::chrono::milliseconds(100)) {
+        return;
+    }
+    lastShow = now;
+    // js can only be called from its own thread
+    if (std::this_thread::get_id() == thread) {
+        Notify(GetPosition());
+    } else if (post) {
+        post(GetPosition());
+    }
+}
+
+void JsProgress::SetPost(std::function<void(double)> fn) {
+    post = fn;
+}
+
+void JsProgress::Notify(double fraction) {
+    if (callback.IsEmpty() || state) {
+        return;
+    }
+    try {
+        callback.Call({ Napi::Number::New(env, fraction) });
+    } catch (Napi::Error &err) {
+        error = err.Message();
+        state = PROGRESS_FAILED;
+    }
+}
+
+void JsProgress::Flush() {
+    if (std::this_thread::get_id() == thread) {
+        Notify(GetPosition());
+    }
+}
+
+std::string JsProgress::Reason() {
+    switch (state) {
+        case PROGRESS_ABORTED: return "aborted";
+        case PROGRESS_TIMEOUT: return "timed out";
+        case PROGRESS_FAILED: return "stopped by onProgress: " + error;
+        default: return "";
+    }
+}
+
+void JsProgress::Release() {
+    signalRef.Reset();
+    callback.Reset();
+    post = nullptr;
+    signal = nullptr;
+}
+
+Handle(JsProgress) GetProgress(const Napi::CallbackInfo &info, size_t idx) {
+    return new JsProgress(info.Env(), info.Length() > idx ? info[idx] : info.Env().Undefined());
+}
+
+bool ThrowIfStopped(Napi::Env env, const Handle(JsProgress) &progress, const std::string &name) {
+    // work of OSD_Parallel workers is only seen once it returns
+    progress->Flush();
+    auto reason = progress->Reason();
+    if (!reason.empty()) {
+        Napi::Error::New(env, name + " " + reason).ThrowAsJavaScriptException();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressRange.hxx>
+#include <Message_ProgressScope.hxx>
+
+// stops occt algorithms cooperatively with options of a js call:
+// `signal` is an Int32Array aborting once its first item is not zero, put it on a SharedArrayBuffer to abort from another thread,
+// `timeoutMs` is a time budget, and `onProgress(fraction)` is called on the js thread.
+// Progress of other threads is passed to `SetPost` if set, or reported by `Flush` once the work returns
+class JsProgress : public Message_ProgressIndicator {
+public:
+    JsProgress(Napi::Env env, Napi::Value opts);
+    Standard_Boolean UserBreak() override;
+    void Show(const Message_ProgressScope &scope, const Standard_Boolean isForce) override;
+    // receives the fraction reached on other threads, and has to pass it to `Notify` on the js thread
+    void SetPost(std::function<void(double)> fn);
+    // calls onProgress, only on the js thread
+    void Notify(double fraction);
+    // reports the current position if called on the js thread
+    void Flush();
+    // why the work was stopped, empty if it was not
+    std::string Reason();
+    // references can only be released on the js thread
+    void Release();
+    DEFINE_STANDARD_RTTI_INLINE(JsProgress, Message_ProgressIndicator)
+private:
+    Napi::Env env;
+    Napi::Reference<Napi::Int32Array> signalRef;
+    std::atomic<int32_t> *signal = nullptr;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline, lastShow;
+    Napi::FunctionReference callback;
+    std::function<void(double)> post;
+    std::thread::id thread;
+    std::atomic<int> state { 0 };
+    std::string error;
+};
+
+Handle(JsProgress) GetProgress(const Napi::CallbackInfo &info, size_t idx);
+// throws the reason as js error if the work was stopped
+bool ThrowIfStopped(Napi::Env env, const Handle(JsProgress) &progress, const std::string &name);
@@ -24,10 +24,56 @@
 #include <StepVisual_ColourRgb.hxx>
 #include <Transfer_TransientProcess.hxx>
 #include <TransferBRep.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopExp.hxx>
+#include <BRep_Builder.hxx>
+#include <OSD_MemInfo.hxx>
+#include <Interface_InterfaceModel.hxx>
 
 #include "../topo/shape.h"
+#include "../progress.h"
+
+// "r,g,b" of the first surface fill colour of a styled item
+std::string GetStyleColor(const Handle(StepVisual_StyledItem) &style) {
+    for (int i = 0; i < style->NbStyles(); i ++) {
+        auto item = style->StylesValue(i + 1);
+        for (int j = 0; j < item->NbStyles(); j ++) {
+            auto value = item->StylesValue(j + 1);
+            auto usage = value.SurfaceStyleUsage();
+            if (usage.IsNull()) {
+                continue;
+            }
+            auto style = usage->Style();
+            for (int k = 0; k < style->NbStyles(); k ++) {
+                auto item = style->StylesValue(k + 1);
+                auto fill = item.SurfaceStyleFillArea();
+                if (fill.IsNull()) {
+                    continue;
+                }
+                auto area = fill->FillArea();
+                if (area.IsNull()) {
+                    continue;
+                }
+                for (int u = 0; u < area->NbFillStyles(); u ++) {
+                    auto item = area->FillStylesValue(u + 1);
+                    auto color = item.FillAreaStyleColour()->FillColour();
+                    auto rgb = Handle(StepVisual_ColourRgb)::DownCast(color);
+                    if (!rgb.IsNull()) {
+                        return
+                            std::to_string(rgb->Red()) + "," +
+                            std::to_string(rgb->Green()) + "," +
+                            std::to_string(rgb->Blue());
+                    }
+                }
+            }
+        }
+    }
+    return "";
+}
 
 auto UpdateMeta(STEPControl_Reader &reader) {
+    std::lock_guard<std::mutex> lock(Shape::MetaMutex);
     auto model = reader.WS()->Model();
     auto trans = reader.WS()->TransferReader();
     // https://github.com/Open-Cascade-SAS/OCCT/blob/fd5c113a0367cc5e0b086544f2e900265545aa72/src/STEPCAFControl/STEPCAFControl_Reader.cxx#L1468
@@ -54,42 +100,10 @@ auto UpdateMeta(STEPControl_Reader &reader) {
             if (shape.ShapeType() != TopAbs_ShapeEnum::TopAbs_SOLID) {
                 continue;
             }
-            for (int i = 0; i < style->NbStyles(); i ++) {
-                auto item = style->StylesValue(i + 1);
-                for (int j = 0; j < item->NbStyles(); j ++) {
-                    auto value = item->StylesValue(j + 1);
-                    auto usage = value.SurfaceStyleUsage();
-                    if (usage.IsNull()) {
-                        continue;
-                    }
-                    auto style = usage->Style();
-                    for (int k = 0; k < style->NbStyles(); k ++) {
-                        auto item = style->StylesValue(k + 1);
-                        auto fill = item.SurfaceStyleFillArea();
-                        if (fill.IsNull()) {
-                            continue;
-                        }
-                        auto area = fill->FillArea();
-                        if (area.IsNull()) {
-                            continue;
-                        }
-                        for (int u = 0; u < area->NbFillStyles(); u ++) {
-                            auto item = area->FillStylesValue(u + 1);
-                            auto color = item.FillAreaStyleColour()->FillColour();
-                            auto rgb = Handle(StepVisual_ColourRgb)::DownCast(color);
-                            auto &meta = Shape::MetaMap[shape.HashCode(0x0fffffff)];
-                            meta["ColorRGB"] =
-                                std::to_string(rgb->Red()) + "," +
-                                std::to_string(rgb->Green()) + "," +
-                                std::to_string(rgb->Blue());
-                            // WTF
-                            break;
-                            break;
-                            break;
-                            break;
-                        }
-                    }
-                }
+            auto color = GetStyleColor(style);
+            if (!color.empty()) {
+                auto &meta = Shape::MetaMap[shape.HashCode(0x0fffffff)];
+                meta["ColorRGB"] = color;
             }
         }
     }
@@ -114,12 +128,150 @@ Napi::Value LoadStep(const Napi::CallbackInfo &info) {
         Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
         return info.Env().Undefined();
     } else {
-        reader.TransferRoot();
+        auto progress = GetProgress(info, 1);
+        reader.TransferRoot(1, progress->Start());
+        if (ThrowIfStopped(info.Env(), progress, std::string("load ") + file)) {
+            return info.Env().Undefined();
+        }
         UpdateMeta(reader);
-        return Shape::Create(reader.Shape());
+        return Shape::Create(info.Env(), reader.Shape());
     }
 }
 
+typedef std::map<std::string, std::string> StepMeta;
+
+// layers and colors keyed by the styled entity, collected in one pass so every root can look up its own
+std::map<const Standard_Transient *, StepMeta> CollectEntityMeta(const Handle(Interface_InterfaceModel) &model) {
+    std::map<const Standard_Transient *, StepMeta> ret;
+    for (int i = 0; i < model->NbEntities(); i ++) {
+        auto ent = model->Value(i + 1);
+        if (ent->IsKind(StepVisual_PresentationLayerAssignment::get_type_descriptor())) {
+            auto layer = Handle(StepVisual_PresentationLayerAssignment)::DownCast(ent);
+            for (int i = 0; i < layer->NbAssignedItems(); i ++) {
+                auto &meta = ret[layer->AssignedItemsValue(i + 1).Value().get()];
+                meta["LayerName"] = layer->Name()->ToCString();
+                meta["LayerDescription"] = layer->Description()->ToCString();
+            }
+        } else if (ent->IsKind(StepVisual_StyledItem::get_type_descriptor())) {
+            auto style = Handle(StepVisual_StyledItem)::DownCast(ent);
+            auto color = GetStyleColor(style);
+            if (!color.empty() && !style->Item().IsNull()) {
+                ret[style->Item().get()]["ColorRGB"] = color;
+            }
+        }
+    }
+    return ret;
+}
+
+void UpdateRootMeta(STEPControl_Reader &reader, const TopoDS_Shape &root, const std::map<const Standard_Transient *, StepMeta> &entMeta) {
+    std::lock_guard<std::mutex> lock(Shape::MetaMutex);
+    auto trans = reader.WS()->TransferReader();
+    for (TopExp_Explorer exp(root, TopAbs_ShapeEnum::TopAbs_SOLID); exp.More(); exp.Next()) {
+        auto &shape = exp.Current();
+        auto ent = trans->EntityFromShapeResult(shape, 1);
+        if (ent.IsNull()) {
+            continue;
+        }
+        auto &meta = Shape::MetaMap[shape.HashCode(0x0fffffff)];
+        auto found = entMeta.find(ent.get());
+        if (found != entMeta.end()) {
+            for (auto &[key, value] : found->second) {
+                meta[key] = value;
+            }
+        }
+        if (ent->IsKind(StepShape_ManifoldSolidBrep::get_type_descriptor())) {
+            auto prop = Handle(StepShape_ManifoldSolidBrep)::DownCast(ent);
+            meta["ManifoldSolidBrep"] = prop->Name()->ToCString();
+        }
+    }
+}
+
+// transfers the roots one by one and passes each to `onShape(shape, root)`, or compounds of
+// `opts.batch` solids with `opts.batch` set. With `opts.release` (default true) the transfer results
+// are dropped after every root, so the memory held is the entity model plus one root,
+// but shapes shared by several roots are no longer shared
+Napi::Value StreamStep(const Napi::CallbackInfo &info) {
+    std::string file = info[0].As<Napi::String>();
+    auto callback = info[1].As<Napi::Function>();
+    size_t batch = 0;
+    auto release = true;
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto opts = info[2].As<Napi::Object>();
+        if (opts.Has("batch")) {
+            batch = opts.Get("batch").As<Napi::Number>().Uint32Value();
+        }
+        if (opts.Has("release")) {
+            release = opts.Get("release").ToBoolean().Value();
+        }
+    }
+
+    auto progress = GetProgress(info, 2);
+    int num = 0;
+    // working set sampled before the read and after every root, the process peak would
+    // include whatever ran before this call
+    OSD_MemInfo mem;
+    auto base = mem.Value(OSD_MemInfo::MemWorkingSet), top = base;
+    auto sample = [&]() {
+        mem.Update();
+        auto value = mem.Value(OSD_MemInfo::MemWorkingSet);
+        if (value != Standard_Size(-1)) {
+            top = std::max(top, value);
+        }
+    };
+    {
+        STEPControl_Reader reader;
+        if (reader.ReadFile(file.c_str()) != IFSelect_RetDone) {
+            auto msg = std::string("read from ") + file + " failed";
+            Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+            return info.Env().Undefined();
+        }
+        sample();
+        auto entMeta = CollectEntityMeta(reader.WS()->Model());
+        auto trans = reader.WS()->TransferReader();
+        auto roots = reader.NbRootsForTransfer();
+        Message_ProgressScope scope(progress->Start(), "roots", std::max(roots, 1));
+        for (int i = 1; i <= roots && scope.More(); i ++) {
+            reader.TransferRoot(i, scope.Next());
+            if (!reader.NbShapes()) {
+                continue;
+            }
+            auto shape = reader.Shape(reader.NbShapes());
+            UpdateRootMeta(reader, shape, entMeta);
+            sample();
+            reader.ClearShapes();
+            if (release) {
+                trans->Clear(1);
+                trans->TransientProcess()->Clear();
+            }
+
+            if (batch) {
+                TopTools_IndexedMapOfShape solids;
+                TopExp::MapShapes(shape, TopAbs_SOLID, solids);
+                for (int s = 1; s <= solids.Extent(); s += (int) batch) {
+                    TopoDS_Compound comp;
+                    BRep_Builder builder;
+                    builder.MakeCompound(comp);
+                    for (int k = s; k < s + (int) batch && k <= solids.Extent(); k ++) {
+                        builder.Add(comp, solids(k));
+                    }
+                    callback.Call({ Shape::Create(info.Env(), comp), Napi::Number::New(info.Env(), i - 1) });
+                }
+            } else {
+                callback.Call({ Shape::Create(info.Env(), shape), Napi::Number::New(info.Env(), i - 1) });
+            }
+            num ++;
+        }
+    }
+    if (ThrowIfStopped(info.Env(), progress, std::string("load ") + file)) {
+        return info.Env().Undefined();
+    }
+
+    auto ret = Napi::Object::New(info.Env());
+    ret.Set("roots", num);
+    ret.Set("memoryGrowth", base == Standard_Size(-1) ? -1. : (double) (top - base));
+    return ret;
+}
+
 Napi::Value SaveStep(const Napi::CallbackInfo &info) {
     std::string file = info[0].As<Napi::String>();
     STEPControl_Writer writer;
@@ -2,3 +2,4 @@
 
 Napi::Value LoadStep(const Napi::CallbackInfo &info);
 Napi::Value SaveStep(const Napi::CallbackInfo &info);
+Napi::Value StreamStep(const Napi::CallbackInfo &info);
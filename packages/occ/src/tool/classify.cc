@@ -0,0 +1,267 @@
+#include "classify.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <Bnd_Box.hxx>
+#include <Precision.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <BRepBndLib.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+
+#include "../topo/shape.h"
+#include "../mesh/mesh.h"
+#include "../progress.h"
+#include "voxel.h"
+
+struct ClassifyTarget {
+    TopoDS_Shape shape;
+    Bnd_Box box;
+    // triangles binned over the box in xy, for ray parity
+    MeshData mesh;
+    // false if meshing failed or left faces without triangles, the solid classifier is used then
+    bool useMesh = false;
+    double x0 = 0, y0 = 0, dx = 1, dy = 1;
+    size_t nx = 0, ny = 0;
+    std::vector<uint32_t> binOffsets, binTris;
+};
+
+void BuildTriangleBins(ClassifyTarget &target) {
+    auto &pos = target.mesh.positions;
+    auto &idx = target.mesh.indices;
+    auto triNum = idx.size() / 3;
+    double xmin, ymin, zmin, xmax, ymax, zmax;
+    target.box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+    auto n = std::min(std::max((size_t) std::sqrt((double) triNum), (size_t) 1), (size_t) 256);
+    target.nx = target.ny = n;
+    target.x0 = xmin;
+    target.y0 = ymin;
+    target.dx = std::max((xmax - xmin) / n, Precision::Confusion());
+    target.dy = std::max((ymax - ymin) / n, Precision::Confusion());
+
+    auto cellRange = [&](size_t t, size_t &i0, size_t &i1, size_t &j0, size_t &j1) {
+        auto a = &pos[idx[t * 3] * 3], b = &pos[idx[t * 3 + 1] * 3], c = &pos[idx[t * 3 + 2] * 3];
+        auto clamp = [n](double v) { return (size_t) std::min(std::max(v, 0.), (double) (n - 1)); };
+        i0 = clamp((std::min({ a[0], b[0], c[0] }) - target.x0) / target.dx);
+        i1 = clamp((std::max({ a[0], b[0], c[0] }) - target.x0) / target.dx);
+        j0 = clamp((std::min({ a[1], b[1], c[1] }) - target.y0) / target.dy);
+        j1 = clamp((std::max({ a[1], b[1], c[1] }) - target.y0) / target.dy);
+    };
+    target.binOffsets.assign(n * n + 1, 0);
+    size_t i0, i1, j0, j1;
+    for (size_t t = 0; t < triNum; t ++) {
+        cellRange(t, i0, i1, j0, j1);
+        for (auto j = j0; j <= j1; j ++) {
+            for (auto i = i0; i <= i1; i ++) {
+                target.binOffsets[i + j * n + 1] ++;
+            }
+        }
+    }
+    std::partial_sum(target.binOffsets.begin(), target.binOffsets.end(), target.binOffsets.begin());
+    target.binTris.resize(target.binOffsets.back());
+    std::vector<uint32_t> cursor(target.binOffsets.begin(), target.binOffsets.end() - 1);
+    for (size_t t = 0; t < triNum; t ++) {
+        cellRange(t, i0, i1, j0, j1);
+        for (auto j = j0; j <= j1; j ++) {
+            for (auto i = i0; i <= i1; i ++) {
+                target.binTris[cursor[i + j * n] ++] = (uint32_t) t;
+            }
+        }
+    }
+}
+
+// ray parity is only right on a closed triangulation
+bool IsMeshComplete(const TopoDS_Shape &shape) {
+    TopLoc_Location loc;
+    auto faces = 0;
+    for (TopExp_Explorer ex(shape, TopAbs_FACE); ex.More(); ex.Next(), faces ++) {
+        auto mesh = BRep_Tool::Triangulation(TopoDS::Face(ex.Current()), loc);
+        if (!mesh || !mesh->NbTriangles()) {
+            return false;
+        }
+    }
+    return faces > 0;
+}
+
+// parity of the triangles above the point along z, shared edges are hit once by the top-left rule
+bool IsInsideByRay(const ClassifyTarget &target, double px, double py, double pz) {
+    auto n = target.nx;
+    auto i = (size_t) std::min(std::max((px - target.x0) / target.dx, 0.), (double) (n - 1)),
+        j = (size_t) std::min(std::max((py - target.y0) / target.dy, 0.), (double) (n - 1));
+    auto &pos = target.mesh.positions;
+    auto &idx = target.mesh.indices;
+    size_t hits = 0;
+    double z;
+    for (auto k = target.binOffsets[i + j * n]; k < target.binOffsets[i + j * n + 1]; k ++) {
+        auto t = target.binTris[k];
+        auto a = &pos[idx[t * 3] * 3], b = &pos[idx[t * 3 + 1] * 3], c = &pos[idx[t * 3 + 2] * 3];
+        if (HitTriangleZ(a, b, c, px, py, z) && z > pz) {
+            hits ++;
+        }
+    }
+    return hits % 2 == 1;
+}
+
+// 1 based position in shapes of the solid containing every point, 0 for outside and later shapes win like `tool.voxelize`.
+// points are tested with BRepClass3d_SolidClassifier, or by ray parity on the triangulation with `opts.mesh`
+// except for shapes that failed to mesh completely
+Napi::Value Classify(const Napi::CallbackInfo &info) {
+    auto list = info[0].As<Napi::Array>();
+    if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float64_array) {
+        Napi::TypeError::New(info.Env(), "points should be a Float64Array").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+    auto points = info[1].As<Napi::Float64Array>();
+    auto pts = points.Data();
+    auto ptNum = points.ElementLength() / 3;
+    auto tol = Precision::Confusion();
+    auto useMesh = false;
+    if (info.Length() > 2 && info[2].IsObject()) {
+        auto opts = info[2].As<Napi::Object>();
+        if (opts.Has("tol")) {
+            tol = opts.Get("tol").As<Napi::Number>().DoubleValue();
+        }
+        if (opts.Has("mesh")) {
+            useMesh = opts.Get("mesh").ToBoolean().Value();
+        }
+    }
+    auto params = GetMeshParams(info, 2);
+    auto progress = GetProgress(info, 2);
+
+    std::vector<ClassifyTarget> targets(list.Length());
+    std::vector<TopoDS_Shape> shapes(targets.size());
+    for (uint32_t i = 0; i < targets.size(); i ++) {
+        shapes[i] = targets[i].shape = Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape;
+    }
+    size_t groupNum = 0;
+    auto groups = GetMeshLockGroups(shapes, groupNum);
+    std::vector<std::mutex> locks(groupNum);
+    std::string error;
+    std::mutex errorMutex;
+    OSD_Parallel::For(0, (int) targets.size(), [&](int i) {
+        auto &target = targets[i];
+        // the box reads face triangulations, which another thread may be replacing on shared faces
+        std::unique_lock<std::mutex> lock(locks[groups[i]]);
+        try {
+            BRepBndLib::Add(target.shape, target.box);
+        } catch (Standard_Failure &err) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = std::string("classify shape ") + std::to_string(i) + " failed: " + err.GetMessageString();
+        }
+        if (target.box.IsVoid()) {
+            return;
+        }
+        target.box.Enlarge(tol);
+        if (useMesh) {
+            try {
+                target.mesh = BuildMesh(target.shape, params);
+                target.useMesh = IsMeshComplete(target.shape);
+            } catch (Standard_Failure &) {
+                target.useMesh = false;
+            }
+            lock.unlock();
+            if (target.useMesh) {
+                BuildTriangleBins(target);
+            } else {
+                target.mesh = MeshData();
+            }
+        }
+    });
+
+    // candidates of every shape from the points sorted along x, split into chunks
+    std::vector<uint32_t> order(ptNum);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return pts[a * 3] < pts[b * 3]; });
+    std::vector<double> xs(ptNum);
+    for (size_t i = 0; i < ptNum; i ++) {
+        xs[i] = pts[order[i] * 3];
+    }
+    std::vector<std::vector<uint32_t>> candidates(targets.size());
+    struct WorkItem { uint32_t shape; size_t begin, end; };
+    std::vector<WorkItem> items;
+    const size_t chunkSize = 4096;
+    for (uint32_t s = 0; s < targets.size(); s ++) {
+        auto &box = targets[s].box;
+        if (box.IsVoid()) {
+            continue;
+        }
+        double xmin, ymin, zmin, xmax, ymax, zmax;
+        box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+        auto begin = std::lower_bound(xs.begin(), xs.end(), xmin) - xs.begin(),
+            end = std::upper_bound(xs.begin(), xs.end(), xmax) - xs.begin();
+        auto &list = candidates[s];
+        for (auto k = begin; k < end; k ++) {
+            auto p = &pts[order[k] * 3];
+            if (p[1] >= ymin && p[1] <= ymax && p[2] >= zmin && p[2] <= zmax) {
+                list.push_back(order[k]);
+            }
+        }
+        for (size_t k = 0; k < list.size(); k += chunkSize) {
+            items.push_back({ s, k, std::min(k + chunkSize, list.size()) });
+        }
+    }
+
+    std::unique_ptr<std::atomic<uint32_t>[]> result(new std::atomic<uint32_t>[ptNum]());
+    OSD_Parallel::For(0, (int) items.size(), [&](int w) {
+        if (progress->UserBreak()) {
+            return;
+        }
+        auto &item = items[w];
+        auto &target = targets[item.shape];
+        auto &list = candidates[item.shape];
+        auto value = item.shape + 1;
+        std::unique_ptr<BRepClass3d_SolidClassifier> classifier;
+        try {
+            if (!target.useMesh) {
+                // built once per chunk and reused for all its points
+                classifier.reset(new BRepClass3d_SolidClassifier(target.shape));
+            }
+            for (auto k = item.begin; k < item.end; k ++) {
+                auto p = &pts[list[k] * 3];
+                auto inside = false;
+                if (target.useMesh) {
+                    inside = IsInsideByRay(target, p[0], p[1], p[2]);
+                } else {
+                    classifier->Perform(gp_Pnt(p[0], p[1], p[2]), tol);
+                    inside = classifier->State() == TopAbs_IN;
+                }
+                if (inside) {
+                    auto &slot = result[list[k]];
+                    auto prev = slot.load();
+                    while (prev < value && !slot.compare_exchange_weak(prev, value)) { }
+                }
+            }
+        } catch (Standard_Failure &err) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = std::string("classify shape ") + std::to_string(item.shape) + " failed: " + err.GetMessageString();
+        }
+    });
+    if (ThrowIfStopped(info.Env(), progress, "classify")) {
+        return info.Env().Undefined();
+    } else if (!error.empty()) {
+        Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    // the narrowest array that holds every shape position
+    if (list.Length() <= 0xff) {
+        auto ret = Napi::Uint8Array::New(info.Env(), ptNum);
+        for (size_t i = 0; i < ptNum; i ++) ret[i] = (uint8_t) result[i].load();
+        return ret;
+    } else if (list.Length() <= 0xffff) {
+        auto ret = Napi::Uint16Array::New(info.Env(), ptNum);
+        for (size_t i = 0; i < ptNum; i ++) ret[i] = (uint16_t) result[i].load();
+        return ret;
+    } else {
+        auto ret = Napi::Uint32Array::New(info.Env(), ptNum);
+        for (size_t i = 0; i < ptNum; i ++) ret[i] = result[i].load();
+        return ret;
+    }
+}
@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value Classify(const Napi::CallbackInfo &info);
@@ -0,0 +1,166 @@
+#include "clearance.h"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <Bnd_Box.hxx>
+#include <Precision.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <GProp_GProps.hxx>
+#include <BRepGProp.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepAlgoAPI_Common.hxx>
+#include <BRepExtrema_DistShapeShape.hxx>
+
+#include "../topo/shape.h"
+#include "../progress.h"
+
+struct ClearancePair {
+    uint32_t a, b;
+    double dist = -1, points[6];
+    uint8_t overlap = 0;
+};
+
+// pairs whose boxes are within `maxDistance`, swept along x
+std::vector<ClearancePair> GetCandidatePairs(const std::vector<Bnd_Box> &boxes, double maxDistance) {
+    std::vector<uint32_t> order(boxes.size());
+    std::iota(order.begin(), order.end(), 0);
+    order.erase(std::remove_if(order.begin(), order.end(), [&](uint32_t i) { return boxes[i].IsVoid(); }), order.end());
+    std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+        return boxes[i].CornerMin().X() < boxes[j].CornerMin().X();
+    });
+    std::vector<ClearancePair> ret;
+    for (size_t m = 0; m < order.size(); m ++) {
+        auto &bi = boxes[order[m]];
+        auto maxX = bi.CornerMax().X() + maxDistance;
+        for (size_t n = m + 1; n < order.size() && boxes[order[n]].CornerMin().X() <= maxX; n ++) {
+            auto &bj = boxes[order[n]];
+            double gap = 0;
+            for (int d = 1; d <= 3; d ++) {
+                auto g = std::max({ 0., bj.CornerMin().Coord(d) - bi.CornerMax().Coord(d), bi.CornerMin().Coord(d) - bj.CornerMax().Coord(d) });
+                gap += g * g;
+            }
+            if (gap <= maxDistance * maxDistance) {
+                ClearancePair pair;
+                pair.a = std::min(order[m], order[n]);
+                pair.b = std::max(order[m], order[n]);
+                ret.push_back(pair);
+            }
+        }
+    }
+    std::sort(ret.begin(), ret.end(), [](const ClearancePair &p, const ClearancePair &q) {
+        return p.a != q.a ? p.a < q.a : p.b < q.b;
+    });
+    return ret;
+}
+
+// solids in contact overlap if one is inside the other or their common part has volume
+uint8_t GetOverlap(const TopoDS_Shape &a, const TopoDS_Shape &b, BRepExtrema_DistShapeShape &dist) {
+    if (dist.InnerSolution()) {
+        return 1;
+    }
+    if (a.ShapeType() > TopAbs_SOLID || b.ShapeType() > TopAbs_SOLID) {
+        return 0;
+    }
+    BRepAlgoAPI_Common api;
+    TopTools_ListOfShape args, tools;
+    args.Append(a);
+    tools.Append(b);
+    api.SetArguments(args);
+    api.SetTools(tools);
+    // inputs are shared by other pairs running at the same time
+    api.SetNonDestructive(Standard_True);
+    api.SetRunParallel(Standard_False);
+    api.Build();
+    if (api.HasErrors()) {
+        return 0;
+    }
+    GProp_GProps props;
+    BRepGProp::VolumeProperties(api.Shape(), props);
+    return props.Mass() > Precision::Confusion() ? 1 : 0;
+}
+
+// pairs of shapes within `opts.maxDistance` (default 0, touching or overlapping),
+// with the distance, closest points and whether they overlap
+Napi::Value MakeClearance(const Napi::CallbackInfo &info) {
+    std::vector<TopoDS_Shape> shapes;
+    auto list = info[0].As<Napi::Array>();
+    for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+        shapes.push_back(Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape);
+    }
+    double maxDistance = 0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        auto opts = info[1].As<Napi::Object>();
+        if (opts.Has("maxDistance")) {
+            maxDistance = opts.Get("maxDistance").As<Napi::Number>().DoubleValue();
+        }
+    }
+    auto tol = std::max(maxDistance, Precision::Confusion());
+
+    std::vector<Bnd_Box> boxes(shapes.size());
+    for (size_t i = 0; i < shapes.size(); i ++) {
+        BRepBndLib::Add(shapes[i], boxes[i]);
+    }
+    auto pairs = GetCandidatePairs(boxes, tol);
+
+    auto progress = GetProgress(info, 1);
+    Message_ProgressScope scope(progress->Start(), "clearance", (Standard_Real) std::max(pairs.size(), (size_t) 1));
+    std::vector<Message_ProgressRange> ranges;
+    ranges.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i ++) {
+        ranges.push_back(scope.Next());
+    }
+    std::string error;
+    std::mutex errorMutex;
+    OSD_Parallel::For(0, (int) pairs.size(), [&](int i) {
+        auto &pair = pairs[i];
+        auto &a = shapes[pair.a], &b = shapes[pair.b];
+        try {
+            BRepExtrema_DistShapeShape dist;
+            dist.LoadS1(a);
+            dist.LoadS2(b);
+            dist.SetFlag(Extrema_ExtFlag_MIN);
+            if (!dist.Perform(ranges[i]) || !dist.IsDone() || dist.Value() > tol) {
+                return;
+            }
+            pair.dist = dist.Value();
+            auto p = dist.PointOnShape1(1), q = dist.PointOnShape2(1);
+            double points[6] = { p.X(), p.Y(), p.Z(), q.X(), q.Y(), q.Z() };
+            std::copy(points, points + 6, pair.points);
+            if (pair.dist <= Precision::Confusion()) {
+                pair.overlap = GetOverlap(a, b, dist);
+            }
+        } catch (Standard_Failure &err) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            error = std::string("clearance of ") + std::to_string(pair.a) + " and " + std::to_string(pair.b) + " failed: " + err.GetMessageString();
+        }
+    });
+    if (ThrowIfStopped(info.Env(), progress, "clearance")) {
+        return info.Env().Undefined();
+    } else if (!error.empty()) {
+        Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [](const ClearancePair &p) { return p.dist < 0; }), pairs.end());
+    auto env = info.Env();
+    auto indices = Napi::Uint32Array::New(env, pairs.size() * 2);
+    auto distances = Napi::Float64Array::New(env, pairs.size());
+    auto points = Napi::Float64Array::New(env, pairs.size() * 6);
+    auto overlaps = Napi::Uint8Array::New(env, pairs.size());
+    for (size_t i = 0; i < pairs.size(); i ++) {
+        auto &pair = pairs[i];
+        indices[i * 2] = pair.a;
+        indices[i * 2 + 1] = pair.b;
+        distances[i] = pair.dist;
+        std::copy(pair.points, pair.points + 6, points.Data() + i * 6);
+        overlaps[i] = pair.overlap;
+    }
+    auto ret = Napi::Object::New(env);
+    ret.Set("pairs", indices);
+    ret.Set("distances", distances);
+    ret.Set("points", points);
+    ret.Set("overlaps", overlaps);
+    return ret;
+}
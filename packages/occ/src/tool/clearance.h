@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value MakeClearance(const Napi::CallbackInfo &info);
@@ -0,0 +1,206 @@
+#include "conformal.h"
+
+#include <algorithm>
+#include <OSD_Parallel.hxx>
+
+#include "../topo/shape.h"
+#include "../mesh/mesh.h"
+#include "../utils.h"
+#include "voxel.h"
+
+// grid lines of one axis frame (a, b, c), where edges run along c and faces are normal to a
+struct GridFrame {
+    const std::vector<double> &as, &bs, &cs;
+    // maps (ia, ib, ic) to i + nx * (j + ny * k)
+    size_t sa, sb, sc;
+    size_t At(size_t ia, size_t ib, size_t ic) const {
+        return ia * sa + ib * sb + ic * sc;
+    }
+};
+
+// length of c edges inside the mesh, at every grid node (a_i, b_j) by signed ray crossings
+void FillEdgeLength(const std::vector<float> &pos, const std::vector<uint32_t> &idx, const GridFrame &grid, std::vector<float> &len) {
+    auto &as = grid.as, &bs = grid.bs, &cs = grid.cs;
+    std::vector<std::vector<uint32_t>> rows(bs.size());
+    for (size_t t = 0; t < idx.size(); t += 3) {
+        auto a = &pos[idx[t] * 3], b = &pos[idx[t + 1] * 3], c = &pos[idx[t + 2] * 3];
+        auto [j0, j1] = GetCellRange(bs, std::min({ a[1], b[1], c[1] }), std::max({ a[1], b[1], c[1] }));
+        for (auto j = j0; j < j1; j ++) {
+            rows[j].push_back((uint32_t) t);
+        }
+    }
+    OSD_Parallel::For(0, (int) bs.size(), [&](int j) {
+        std::vector<std::vector<double>> hits(as.size());
+        for (auto t : rows[j]) {
+            auto a = &pos[idx[t] * 3], b = &pos[idx[t + 1] * 3], c = &pos[idx[t + 2] * 3];
+            auto [i0, i1] = GetCellRange(as, std::min({ a[0], b[0], c[0] }), std::max({ a[0], b[0], c[0] }));
+            double z;
+            for (auto i = i0; i < i1; i ++) {
+                if (HitTriangleZ(a, b, c, as[i], bs[j], z)) {
+                    hits[i].push_back(z);
+                }
+            }
+        }
+        for (size_t i = 0; i < as.size(); i ++) {
+            auto &arr = hits[i];
+            std::sort(arr.begin(), arr.end());
+            for (size_t h = 0; h + 1 < arr.size(); h += 2) {
+                auto [k0, k1] = GetCellRange(cs, arr[h], arr[h + 1]);
+                for (auto k = k0 > 0 ? k0 - 1 : 0; k < std::min(k1, cs.size() - 1); k ++) {
+                    auto d = std::min(arr[h + 1], cs[k + 1]) - std::max(arr[h], cs[k]);
+                    if (d > 0) {
+                        len[grid.At(i, j, k)] += (float) d;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// clips the segment p -> q to b0 <= b < b1, c0 <= c <= c1, and returns the parameter range
+bool ClipSegment(const double *p, const double *q, double b0, double b1, double c0, double c1, double &t0, double &t1) {
+    t0 = 0;
+    t1 = 1;
+    double db = q[0] - p[0], dc = q[1] - p[1];
+    double ps[4] = { -db, db, -dc, dc },
+        qs[4] = { p[0] - b0, b1 - p[0], p[1] - c0, c1 - p[1] };
+    for (int e = 0; e < 4; e ++) {
+        if (ps[e] == 0) {
+            // segments lying on b1 belong to the next cell
+            if (e == 1 ? qs[e] <= 0 : qs[e] < 0) {
+                return false;
+            }
+        } else if (ps[e] < 0) {
+            t0 = std::max(t0, qs[e] / ps[e]);
+        } else {
+            t1 = std::min(t1, qs[e] / ps[e]);
+        }
+    }
+    return t0 < t1;
+}
+
+// area of a faces inside the mesh by Green's theorem, with F = (b - b0, 0) the
+// boundary integral is the sliced segments plus the inner length of the b1 edge
+void FillFaceArea(const std::vector<float> &pos, const std::vector<uint32_t> &idx, const GridFrame &grid,
+        const std::vector<float> &len, std::vector<float> &area) {
+    auto &as = grid.as, &bs = grid.bs, &cs = grid.cs;
+    std::vector<std::vector<uint32_t>> planes(as.size());
+    for (size_t t = 0; t < idx.size(); t += 3) {
+        auto a = pos[idx[t] * 3], b = pos[idx[t + 1] * 3], c = pos[idx[t + 2] * 3];
+        // vertices on the plane count as below it, as if the plane was moved a little higher
+        // which is also where the top-left rule puts the rays of FillEdgeLength
+        auto i0 = std::lower_bound(as.begin(), as.end(), std::min({ a, b, c })) - as.begin(),
+            i1 = std::lower_bound(as.begin(), as.end(), std::max({ a, b, c })) - as.begin();
+        for (auto i = i0; i < i1; i ++) {
+            planes[i].push_back((uint32_t) t);
+        }
+    }
+    OSD_Parallel::For(0, (int) as.size(), [&](int i) {
+        auto x = as[i];
+        for (auto t : planes[i]) {
+            const float *v[3] = { &pos[idx[t] * 3], &pos[idx[t + 1] * 3], &pos[idx[t + 2] * 3] };
+            bool above[3] = { v[0][0] > x, v[1][0] > x, v[2][0] > x };
+            auto m = above[0] == above[1] ? 2 : above[0] == above[2] ? 1 : 0;
+            double seg[2][2];
+            for (int e = 0; e < 2; e ++) {
+                auto u = v[m], w = v[(m + 1 + e) % 3];
+                auto r = (x - u[0]) / ((double) w[0] - u[0]);
+                seg[e][0] = u[1] + r * ((double) w[1] - u[1]);
+                seg[e][1] = u[2] + r * ((double) w[2] - u[2]);
+            }
+            // outward direction of the section boundary is the projection of the triangle normal
+            double e1[3] = { (double) v[1][0] - v[0][0], (double) v[1][1] - v[0][1], (double) v[1][2] - v[0][2] },
+                e2[3] = { (double) v[2][0] - v[0][0], (double) v[2][1] - v[0][1], (double) v[2][2] - v[0][2] };
+            auto nb = e1[2] * e2[0] - e1[0] * e2[2],
+                nc = e1[0] * e2[1] - e1[1] * e2[0];
+            auto db = seg[1][0] - seg[0][0], dc = seg[1][1] - seg[0][1];
+            auto sign = dc * nb - db * nc > 0 ? 1. : -1.;
+
+            auto [j0, j1] = GetCellRange(bs, std::min(seg[0][0], seg[1][0]), std::max(seg[0][0], seg[1][0]));
+            auto [k0, k1] = GetCellRange(cs, std::min(seg[0][1], seg[1][1]), std::max(seg[0][1], seg[1][1]));
+            for (auto j = j0 > 0 ? j0 - 1 : 0; j < std::min(j1, bs.size() - 1); j ++) {
+                for (auto k = k0 > 0 ? k0 - 1 : 0; k < std::min(k1, cs.size() - 1); k ++) {
+                    double t0, t1;
+                    if (ClipSegment(seg[0], seg[1], bs[j], bs[j + 1], cs[k], cs[k + 1], t0, t1)) {
+                        auto b = seg[0][0] + (t0 + t1) / 2 * db;
+                        area[grid.At(i, j, k)] += (float) ((b - bs[j]) * sign * (t1 - t0) * dc);
+                    }
+                }
+            }
+        }
+        for (size_t j = 0; j + 1 < bs.size(); j ++) {
+            for (size_t k = 0; k + 1 < cs.size(); k ++) {
+                area[grid.At(i, j, k)] += (float) ((bs[j + 1] - bs[j]) * len[grid.At(i, j + 1, k)]);
+            }
+        }
+    });
+}
+
+void AddFractions(const std::vector<float> &pos, const std::vector<uint32_t> &idx,
+        const std::vector<double> *lines, int axis, std::vector<float> &lenRet, std::vector<float> &areaRet) {
+    size_t strides[3] = { 1, lines[0].size(), lines[0].size() * lines[1].size() };
+    int a = axis, b = (axis + 1) % 3, c = (axis + 2) % 3;
+    GridFrame grid { lines[a], lines[b], lines[c], strides[a], strides[b], strides[c] };
+
+    std::vector<float> perm(pos.size());
+    for (size_t n = 0; n < pos.size(); n += 3) {
+        perm[n] = pos[n + a];
+        perm[n + 1] = pos[n + b];
+        perm[n + 2] = pos[n + c];
+    }
+    auto total = lenRet.size();
+    std::vector<float> len(total), area(total);
+    FillEdgeLength(perm, idx, grid, len);
+    FillFaceArea(perm, idx, grid, len, area);
+
+    // overlapping shapes are clamped, fuse them first for exact values
+    for (size_t ia = 0; ia < grid.as.size(); ia ++) {
+        for (size_t ib = 0; ib < grid.bs.size(); ib ++) {
+            for (size_t ic = 0; ic + 1 < grid.cs.size(); ic ++) {
+                auto n = grid.At(ia, ib, ic);
+                auto dc = grid.cs[ic + 1] - grid.cs[ic];
+                if (dc > 0) {
+                    lenRet[n] = std::min(1.f, lenRet[n] + (float) (len[n] / dc));
+                }
+                auto db = ib + 1 < grid.bs.size() ? grid.bs[ib + 1] - grid.bs[ib] : 0;
+                if (db > 0 && dc > 0) {
+                    areaRet[n] = std::min(1.f, areaRet[n] + (float) (area[n] / db / dc));
+                }
+            }
+        }
+    }
+}
+
+Napi::Value MakeConformal(const Napi::CallbackInfo &info) {
+    auto list = info[0].As<Napi::Array>();
+    std::vector<double> lines[3] = {
+        toDoubleArr(info[1].As<Napi::Array>()),
+        toDoubleArr(info[2].As<Napi::Array>()),
+        toDoubleArr(info[3].As<Napi::Array>()),
+    };
+    auto params = GetMeshParams(info, 4);
+
+    auto total = lines[0].size() * lines[1].size() * lines[2].size();
+    // edges along axis c are in l[c], faces normal to axis a are in s[a]
+    std::vector<float> len[3] = { std::vector<float>(total), std::vector<float>(total), std::vector<float>(total) },
+        area[3] = { std::vector<float>(total), std::vector<float>(total), std::vector<float>(total) };
+    for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+        auto &shape = Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape;
+        auto mesh = BuildMesh(shape, params);
+        for (int axis = 0; axis < 3; axis ++) {
+            AddFractions(mesh.positions, mesh.indices, lines, axis, len[(axis + 2) % 3], area[axis]);
+        }
+    }
+
+    auto ret = Napi::Object::New(info.Env());
+    const char *names[2][3] = { { "lx", "ly", "lz" }, { "sx", "sy", "sz" } };
+    for (int axis = 0; axis < 3; axis ++) {
+        auto l = Napi::Float32Array::New(info.Env(), total);
+        std::copy(len[axis].begin(), len[axis].end(), l.Data());
+        ret.Set(names[0][axis], l);
+        auto s = Napi::Float32Array::New(info.Env(), total);
+        std::copy(area[axis].begin(), area[axis].end(), s.Data());
+        ret.Set(names[1][axis], s);
+    }
+    return ret;
+}
@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value MakeConformal(const Napi::CallbackInfo &info);
@@ -1,6 +1,7 @@
 #include "mesh.h"
 
 #include <gp_Pln.hxx>
+#include <algorithm>
 #include <Bnd_Box.hxx>
 #include <GProp_GProps.hxx>
 #include <BRepGProp.hxx>
@@ -14,6 +15,7 @@
 
 #include "../topo/shape.h"
 #include "../utils.h"
+#include "../progress.h"
 
 typedef struct double3 {
     double x;
@@ -51,10 +53,32 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
         shapes.push_back(makeArgsAndTools(api, shape, face));
     }
 
+    auto progress = GetProgress(info, 4);
+    Message_ProgressScope scope(progress->Start(), "mesh", 2);
+
+    // fuse all the slices in one run instead of one boolean per shape
     auto merged = shapes[0];
-    for (int i = 1, n = shapes.size(); i < n; i ++) {
+    auto failed = false;
+    if (shapes.size() > 1) {
         BRepAlgoAPI_Fuse api;
-        merged = makeArgsAndTools(api, shapes[i], merged);
+        TopTools_ListOfShape args, tools;
+        args.Append(shapes[0]);
+        for (size_t i = 1; i < shapes.size(); i ++) {
+            tools.Append(shapes[i]);
+        }
+        api.SetArguments(args);
+        api.SetTools(tools);
+        api.Build(scope.Next());
+        failed = api.HasErrors();
+        if (!failed) {
+            merged = api.Shape();
+        }
+    }
+    if (ThrowIfStopped(info.Env(), progress, "mesh")) {
+        return info.Env().Undefined();
+    } else if (failed) {
+        Napi::Error::New(info.Env(), "Fuse Failed").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
     }
 
     Bnd_Box box;
@@ -64,7 +88,8 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
 
     auto ret = Napi::Array::New(info.Env());
     int num = 0;
-    for (int i = 0, nx = xs.size(); i < nx - 1; i ++) {
+    Message_ProgressScope slabs(scope.Next(), "slabs", std::max((int) xs.size() - 1, 1));
+    for (int i = 0, nx = xs.size(); i < nx - 1 && slabs.More(); i ++, slabs.Next()) {
         auto xa = xs[i], xb = xs[i + 1];
         if (xmin <= xb && xa <= xmax) {
             auto px = merged;
@@ -75,7 +100,7 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
                     gp_Pnt(xb, max.y + 1, max.z + 1)).Shape();
                 px = makeArgsAndTools(api, merged, box);
             }
-            for (int j = 0, ny = ys.size(), nb = px.NbChildren(); nb && j < ny - 1; j ++) {
+            for (int j = 0, ny = ys.size(), nb = px.NbChildren(); nb && j < ny - 1 && !progress->UserBreak(); j ++) {
                 auto ya = ys[j], yb = ys[j + 1];
                 if (ymin <= yb && ya <= ymax) {
                     auto py = px;
@@ -86,7 +111,7 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
                             gp_Pnt(max.x + 1, yb, max.z + 1)).Shape();
                         py = makeArgsAndTools(api, px, box);
                     }
-                    for (int k = 0, nz = zs.size(), nb = py.NbChildren(); nb && k < nz - 1; k ++) {
+                    for (int k = 0, nz = zs.size(), nb = py.NbChildren(); nb && k < nz - 1 && !progress->UserBreak(); k ++) {
                         auto za = zs[k], zb = zs[k + 1];
                         if (zmin <= zb && za <= zmax) {
                             auto pz = py;
@@ -102,7 +127,7 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
                                 item.Set("i", i);
                                 item.Set("j", j);
                                 item.Set("k", k);
-                                item.Set("p", Shape::Create(pz));
+                                item.Set("p", Shape::Create(info.Env(), pz));
                                 GProp_GProps props;
                                 BRepGProp::SurfaceProperties(pz, props);
                                 item.Set("s", props.Mass());
@@ -116,5 +141,8 @@ Napi::Value MakeMesh(const Napi::CallbackInfo &info) {
             }
         }
     }
+    if (ThrowIfStopped(info.Env(), progress, "mesh")) {
+        return info.Env().Undefined();
+    }
     return ret;
 }
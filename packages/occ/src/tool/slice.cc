@@ -0,0 +1,161 @@
+#include "slice.h"
+
+#include <gp_Pln.hxx>
+#include <Precision.hxx>
+#include <Bnd_Box.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_HSequenceOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Wire.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepTools_WireExplorer.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAlgoAPI_Section.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
+#include <ShapeAnalysis_FreeBounds.hxx>
+
+#include "../topo/shape.h"
+#include "../mesh/mesh.h"
+#include "../utils.h"
+
+struct SliceData {
+    std::vector<float> positions;
+    // point offset of every loop
+    std::vector<uint32_t> loops;
+    std::vector<uint8_t> closed;
+    // the section failed, which is not the same as no intersection
+    bool failed = false;
+};
+
+void AddWire(const TopoDS_Wire &wire, const IMeshTools_Parameters &params, SliceData &ret) {
+    auto start = ret.positions.size();
+    ret.loops.push_back((uint32_t) (start / 3));
+    for (BRepTools_WireExplorer ex(wire); ex.More(); ex.Next()) {
+        BRepAdaptor_Curve curve(ex.Current());
+        GCPnts_TangentialDeflection points(curve, params.Angle, params.Deflection);
+        auto reversed = ex.Current().Orientation() == TopAbs_REVERSED;
+        auto n = points.NbPoints();
+        // the first point of an edge is the last one of the previous edge
+        for (int i = ret.positions.size() > start ? 2 : 1; i <= n; i ++) {
+            auto p = points.Value(reversed ? n - i + 1 : i);
+            ret.positions.push_back((float) p.X());
+            ret.positions.push_back((float) p.Y());
+            ret.positions.push_back((float) p.Z());
+        }
+    }
+    auto &pos = ret.positions;
+    auto end = pos.size();
+    ret.closed.push_back(end - start > 3 &&
+        gp_Pnt(pos[start], pos[start + 1], pos[start + 2]).Distance(gp_Pnt(pos[end - 3], pos[end - 2], pos[end - 1])) <= params.Deflection);
+}
+
+SliceData MakeSlice(const TopoDS_Shape &faces, const gp_Pln &plane, const IMeshTools_Parameters &params) {
+    SliceData ret;
+    BRepAlgoAPI_Section api(faces, plane, Standard_False);
+    // planes are running in parallel already, and they all share the input faces
+    api.SetRunParallel(Standard_False);
+    api.SetNonDestructive(Standard_True);
+    api.Build();
+    if (api.HasErrors()) {
+        ret.failed = true;
+        return ret;
+    }
+
+    Handle(TopTools_HSequenceOfShape) edges = new TopTools_HSequenceOfShape(), wires;
+    for (TopExp_Explorer ex(api.Shape(), TopAbs_EDGE); ex.More(); ex.Next()) {
+        edges->Append(ex.Current());
+    }
+    ShapeAnalysis_FreeBounds::ConnectEdgesToWires(edges, Precision::Confusion(), Standard_False, wires);
+    for (int i = 1; i <= wires->Length(); i ++) {
+        AddWire(TopoDS::Wire(wires->Value(i)), params, ret);
+    }
+    return ret;
+}
+
+Napi::Value MakeSlices(const Napi::CallbackInfo &info) {
+    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    auto axis = info[1].As<Napi::Number>().Int32Value();
+    auto positions = toDoubleArr(info[2].As<Napi::Array>());
+    auto params = GetMeshParams(info, 3);
+    if (axis < 0 || axis > 2) {
+        Napi::Error::New(info.Env(), "axis should be 0, 1 or 2").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+
+    // bounding range of every face along the axis, shared by all planes
+    TopTools_IndexedMapOfShape faces;
+    TopExp::MapShapes(shape, TopAbs_FACE, faces);
+    std::vector<std::pair<double, double>> ranges(faces.Extent());
+    for (int i = 1; i <= faces.Extent(); i ++) {
+        Bnd_Box box;
+        BRepBndLib::Add(faces(i), box);
+        double min[3], max[3];
+        box.Get(min[0], min[1], min[2], max[0], max[1], max[2]);
+        ranges[i - 1] = std::make_pair(min[axis], max[axis]);
+    }
+
+    std::vector<SliceData> slices(positions.size());
+    OSD_Parallel::For(0, (int) positions.size(), [&](int p) {
+        auto pos = positions[p];
+        TopoDS_Compound comp;
+        BRep_Builder builder;
+        builder.MakeCompound(comp);
+        int num = 0;
+        for (int i = 0; i < faces.Extent(); i ++) {
+            if (ranges[i].first <= pos && pos <= ranges[i].second) {
+                builder.Add(comp, faces(i + 1));
+                num ++;
+            }
+        }
+        if (num) {
+            gp_Pnt origin(axis == 0 ? pos : 0, axis == 1 ? pos : 0, axis == 2 ? pos : 0);
+            gp_Dir dir(axis == 0 ? 1 : 0, axis == 1 ? 1 : 0, axis == 2 ? 1 : 0);
+            try {
+                slices[p] = MakeSlice(comp, gp_Pln(origin, dir), params);
+            } catch (Standard_Failure &) {
+                slices[p] = SliceData();
+                slices[p].failed = true;
+            }
+        }
+    });
+
+    size_t posNum = 0, loopNum = 0;
+    for (auto &slice : slices) {
+        posNum += slice.positions.size();
+        loopNum += slice.loops.size();
+    }
+    auto pos = Napi::Float32Array::New(info.Env(), posNum);
+    auto loops = Napi::Uint32Array::New(info.Env(), loopNum + 1);
+    auto closed = Napi::Uint8Array::New(info.Env(), loopNum);
+    auto planes = Napi::Uint32Array::New(info.Env(), slices.size() + 1);
+    auto failed = Napi::Uint8Array::New(info.Env(), slices.size());
+    posNum = loopNum = 0;
+    for (size_t p = 0; p < slices.size(); p ++) {
+        auto &slice = slices[p];
+        planes[p] = (uint32_t) loopNum;
+        failed[p] = slice.failed ? 1 : 0;
+        for (size_t i = 0; i < slice.loops.size(); i ++, loopNum ++) {
+            loops[loopNum] = (uint32_t) (posNum / 3) + slice.loops[i];
+            closed[loopNum] = slice.closed[i];
+        }
+        std::copy(slice.positions.begin(), slice.positions.end(), pos.Data() + posNum);
+        posNum += slice.positions.size();
+    }
+    planes[slices.size()] = (uint32_t) loopNum;
+    loops[loopNum] = (uint32_t) (posNum / 3);
+
+    auto ret = Napi::Object::New(info.Env());
+    ret.Set("positions", pos);
+    ret.Set("loops", loops);
+    ret.Set("closed", closed);
+    ret.Set("planes", planes);
+    ret.Set("failed", failed);
+    return ret;
+}
@@ -0,0 +1,3 @@
+#include <napi.h>
+
+Napi::Value MakeSlices(const Napi::CallbackInfo &info);
@@ -0,0 +1,103 @@
+#include "voxel.h"
+
+#include <algorithm>
+#include <OSD_Parallel.hxx>
+
+#include "../topo/shape.h"
+#include "../mesh/mesh.h"
+#include "../utils.h"
+
+// evaluate in a fixed vertex order, so two triangles sharing an edge get exactly opposite values
+inline double edgeFunc(const float *u, const float *v, double px, double py) {
+    if (u[0] < v[0] || (u[0] == v[0] && u[1] < v[1])) {
+        return (v[0] - u[0]) * (py - u[1]) - (v[1] - u[1]) * (px - u[0]);
+    } else {
+        return -((u[0] - v[0]) * (py - v[1]) - (u[1] - v[1]) * (px - v[0]));
+    }
+}
+
+// top-left rule for counter-clockwise triangles, a ray through a shared edge or vertex hits only one of them
+inline bool isTopLeft(const float *u, const float *v) {
+    return (u[1] == v[1] && v[0] < u[0]) || v[1] < u[1];
+}
+
+bool HitTriangleZ(const float *a, const float *b, const float *c, double px, double py, double &z) {
+    auto area = ((double) b[0] - a[0]) * ((double) c[1] - a[1]) - ((double) b[1] - a[1]) * ((double) c[0] - a[0]);
+    if (area == 0) {
+        return false;
+    } else if (area < 0) {
+        std::swap(b, c);
+    }
+    auto e0 = edgeFunc(a, b, px, py), e1 = edgeFunc(b, c, px, py), e2 = edgeFunc(c, a, px, py);
+    if ((e0 > 0 || (e0 == 0 && isTopLeft(a, b))) &&
+        (e1 > 0 || (e1 == 0 && isTopLeft(b, c))) &&
+        (e2 > 0 || (e2 == 0 && isTopLeft(c, a)))) {
+        z = (e1 * a[2] + e2 * b[2] + e0 * c[2]) / (e0 + e1 + e2);
+        return true;
+    }
+    return false;
+}
+
+// fills cells whose centers are inside the closed mesh, by ray parity along z
+void RasterizeZ(const MeshData &mesh, const std::vector<double> &xc, const std::vector<double> &yc, const std::vector<double> &zc,
+        uint16_t value, std::vector<uint16_t> &grid) {
+    auto &pos = mesh.positions;
+    auto &idx = mesh.indices;
+    auto nx = xc.size(), ny = yc.size();
+    std::vector<std::vector<uint32_t>> rows(ny);
+    for (size_t t = 0; t < idx.size(); t += 3) {
+        auto a = &pos[idx[t] * 3], b = &pos[idx[t + 1] * 3], c = &pos[idx[t + 2] * 3];
+        auto [j0, j1] = GetCellRange(yc, std::min({ a[1], b[1], c[1] }), std::max({ a[1], b[1], c[1] }));
+        for (auto j = j0; j < j1; j ++) {
+            rows[j].push_back((uint32_t) t);
+        }
+    }
+    OSD_Parallel::For(0, (int) ny, [&](int j) {
+        std::vector<std::vector<double>> hits(nx);
+        for (auto t : rows[j]) {
+            auto a = &pos[idx[t] * 3], b = &pos[idx[t + 1] * 3], c = &pos[idx[t + 2] * 3];
+            auto [i0, i1] = GetCellRange(xc, std::min({ a[0], b[0], c[0] }), std::max({ a[0], b[0], c[0] }));
+            double z;
+            for (auto i = i0; i < i1; i ++) {
+                if (HitTriangleZ(a, b, c, xc[i], yc[j], z)) {
+                    hits[i].push_back(z);
+                }
+            }
+        }
+        for (size_t i = 0; i < nx; i ++) {
+            auto &arr = hits[i];
+            std::sort(arr.begin(), arr.end());
+            for (size_t h = 0; h + 1 < arr.size(); h += 2) {
+                auto [k0, k1] = GetCellRange(zc, arr[h], arr[h + 1]);
+                for (auto k = k0; k < k1; k ++) {
+                    grid[i + nx * (j + ny * k)] = value;
+                }
+            }
+        }
+    });
+}
+
+Napi::Value Voxelize(const Napi::CallbackInfo &info) {
+    auto list = info[0].As<Napi::Array>();
+    auto xc = toCellCenters(toDoubleArr(info[1].As<Napi::Array>()));
+    auto yc = toCellCenters(toDoubleArr(info[2].As<Napi::Array>()));
+    auto zc = toCellCenters(toDoubleArr(info[3].As<Napi::Array>()));
+    auto params = GetMeshParams(info, 4);
+
+    // later shapes overwrite earlier ones, 0 is left for empty cells
+    std::vector<uint16_t> grid(xc.size() * yc.size() * zc.size());
+    for (uint32_t i = 0, n = list.Length(); i < n; i ++) {
+        auto &shape = Shape::Unwrap(list.Get(i).As<Napi::Object>())->shape;
+        RasterizeZ(BuildMesh(shape, params), xc, yc, zc, (uint16_t) (i + 1), grid);
+    }
+
+    if (list.Length() < 0xff) {
+        auto ret = Napi::Uint8Array::New(info.Env(), grid.size());
+        std::copy(grid.begin(), grid.end(), ret.Data());
+        return ret;
+    } else {
+        auto ret = Napi::Uint16Array::New(info.Env(), grid.size());
+        std::copy(grid.begin(), grid.end(), ret.Data());
+        return ret;
+    }
+}
@@ -0,0 +1,4 @@
+#include <napi.h>
+
+Napi::Value Voxelize(const Napi::CallbackInfo &info);
+bool HitTriangleZ(const float *a, const float *b, const float *c, double px, double py, double &z);
@@ -0,0 +1,370 @@
+#include "document.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <BRep_Builder.hxx>
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+
+#include "shape.h"
+#include "../utils.h"
+
+// the snapshot is the magic, the entry table and then all shapes in one BinTools compound,
+// which keeps shared sub shapes and triangulations of faces
+const char DocumentMagic[8] = { 'M', 'W', '3', 'D', 'D', 'O', 'C', '1' };
+
+template <typename T>
+void WriteDocumentPod(std::ostream &stream, const T &val) {
+    stream.write((const char *) &val, sizeof(T));
+}
+
+void WriteDocumentString(std::ostream &stream, const std::string &str) {
+    WriteDocumentPod(stream, (uint32_t) str.size());
+    stream.write(str.data(), str.size());
+}
+
+template <typename T>
+void WriteDocumentArray(std::ostream &stream, const std::vector<T> &arr) {
+    WriteDocumentPod(stream, (uint64_t) arr.size());
+    stream.write((const char *) arr.data(), arr.size() * sizeof(T));
+}
+
+// bounds checked reads of a snapshot in memory, `ok` turns false once it runs past the end
+struct DocumentReader {
+    const char *ptr, *end;
+    bool ok = true;
+    bool Take(void *out, size_t size) {
+        ok = ok && (size_t) (end - ptr) >= size;
+        if (ok) {
+            memcpy(out, ptr, size);
+            ptr += size;
+        }
+        return ok;
+    }
+    template <typename T>
+    T Pod() {
+        T val { };
+        Take(&val, sizeof(T));
+        return val;
+    }
+    std::string String() {
+        auto size = Pod<uint32_t>();
+        ok = ok && (size_t) (end - ptr) >= size;
+        std::string str = ok ? std::string(ptr, size) : "";
+        ptr += ok ? size : 0;
+        return str;
+    }
+    template <typename T>
+    void Array(std::vector<T> &arr) {
+        auto size = Pod<uint64_t>();
+        ok = ok && (size_t) (end - ptr) / sizeof(T) >= size;
+        arr.resize(ok ? size : 0);
+        Take(arr.data(), arr.size() * sizeof(T));
+    }
+};
+
+// lets BinTools read the mapped file without copying it into a string
+class DocumentBuf : public std::streambuf {
+public:
+    DocumentBuf(const char *data, size_t size) {
+        auto ptr = const_cast<char *>(data);
+        setg(ptr, ptr, ptr + size);
+    }
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        auto base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        if (base + off < eback() || base + off > egptr()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), base + off, egptr());
+        return pos_type(gptr() - eback());
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override {
+        return seekoff(off_type(pos), std::ios_base::beg, mode);
+    }
+};
+
+Document::Document(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Document>(info) {
+}
+
+void Document::Init(Napi::Env env, Napi::Object exports) {
+    auto func = DefineClass(env, "Document", {
+        InstanceAccessor("size", &Document::Size, NULL),
+        InstanceMethod("ids", &Document::Ids),
+        InstanceMethod("add", &Document::Add),
+        InstanceMethod("addParts", &Document::AddParts),
+        InstanceMethod("remove", &Document::Remove),
+        InstanceMethod("get", &Document::Get),
+        InstanceMethod("attrs", &Document::Attrs),
+        InstanceMethod("setAttrs", &Document::SetAttrs),
+        InstanceMethod("mesh", &Document::Mesh),
+        InstanceMethod("save", &Document::Save),
+        StaticMethod("load", &Document::Load),
+    });
+    GetInstanceData(env).document = Napi::Persistent(func);
+    exports.Set("Document", func);
+}
+
+DocumentEntry *Document::Find(const Napi::CallbackInfo &info) {
+    auto id = info[0].As<Napi::Number>().Uint32Value();
+    auto found = entries.find(id);
+    if (found == entries.end()) {
+        auto msg = std::string("document shape ") + std::to_string(id) + " not found";
+        Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        return nullptr;
+    }
+    return &found->second;
+}
+
+Napi::Value Document::Size(const Napi::CallbackInfo &info) {
+    return Napi::Number::New(info.Env(), (double) entries.size());
+}
+
+Napi::Value Document::Ids(const Napi::CallbackInfo &info) {
+    auto ret = Napi::Uint32Array::New(info.Env(), entries.size());
+    size_t i = 0;
+    for (auto &[id, entry] : entries) {
+        ret[i ++] = id;
+    }
+    return ret;
+}
+
+void SetDocumentAttrs(std::map<std::string, std::string> &attrs, Napi::Value val) {
+    if (!val.IsObject()) {
+        return;
+    }
+    auto obj = val.As<Napi::Object>();
+    auto keys = obj.GetPropertyNames();
+    for (uint32_t i = 0; i < keys.Length(); i ++) {
+        std::string key = keys.Get(i).ToString();
+        auto item = obj.Get(key);
+        // null removes the attribute
+        if (item.IsNull() || item.IsUndefined()) {
+            attrs.erase(key);
+        } else {
+            attrs[key] = item.ToString().Utf8Value();
+        }
+    }
+}
+
+Napi::Value Document::Add(const Napi::CallbackInfo &info) {
+    auto id = nextId ++;
+    auto &entry = entries[id];
+    entry.shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    if (info.Length() > 1) {
+        SetDocumentAttrs(entry.attrs, info[1]);
+    }
+    return Napi::Number::New(info.Env(), id);
+}
+
+// adds every sub shape of the type like `shape.find(type)`, with its meta as attributes
+Napi::Value Document::AddParts(const Napi::CallbackInfo &info) {
+    auto &shape = Shape::Unwrap(info[0].As<Napi::Object>())->shape;
+    auto type = (TopAbs_ShapeEnum) info[1].As<Napi::Number>().Int32Value();
+    TopTools_IndexedMapOfShape parts;
+    TopExp::MapShapes(shape, type, parts);
+    auto ret = Napi::Uint32Array::New(info.Env(), parts.Extent());
+    std::lock_guard<std::mutex> lock(Shape::MetaMutex);
+    for (int i = 1; i <= parts.Extent(); i ++) {
+        auto id = nextId ++;
+        auto &entry = entries[id];
+        entry.shape = parts(i);
+        auto found = Shape::MetaMap.find(entry.shape.HashCode(0x0fffffff));
+        if (found != Shape::MetaMap.end()) {
+            entry.attrs = found->second;
+        }
+        ret[i - 1] = id;
+    }
+    return ret;
+}
+
+Napi::Value Document::Remove(const Napi::CallbackInfo &info) {
+    auto id = info[0].As<Napi::Number>().Uint32Value();
+    return Napi::Boolean::New(info.Env(), entries.erase(id) > 0);
+}
+
+// a new wrapper every call, with the attributes as its own meta so other wrappers of the shape keep theirs
+Napi::Value Document::Get(const Napi::CallbackInfo &info) {
+    auto entry = Find(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    auto ret = Shape::Create(info.Env(), entry->shape);
+    Shape::Unwrap(ret.As<Napi::Object>())->meta.reset(new std::map<std::string, std::string>(entry->attrs));
+    return ret;
+}
+
+Napi::Value Document::Attrs(const Napi::CallbackInfo &info) {
+    auto entry = Find(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    auto ret = Napi::Object::New(info.Env());
+    for (auto &[key, val] : entry->attrs) {
+        ret.Set(key, val);
+    }
+    return ret;
+}
+
+Napi::Value Document::SetAttrs(const Napi::CallbackInfo &info) {
+    auto entry = Find(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    SetDocumentAttrs(entry->attrs, info[1]);
+    return info.Env().Undefined();
+}
+
+Napi::Value Document::Mesh(const Napi::CallbackInfo &info) {
+    auto entry = Find(info);
+    if (!entry) {
+        return info.Env().Undefined();
+    }
+    auto params = GetMeshParams(info, 1);
+    auto optimize = GetMeshOptimize(info, 1);
+    if (!entry->meshed || entry->angle != params.Angle || entry->deflection != params.Deflection || entry->optimized != optimize) {
+        entry->mesh = BuildMesh(entry->shape, params);
+        if (optimize) {
+            OptimizeMesh(entry->mesh);
+        }
+        entry->meshed = true;
+        entry->optimized = optimize;
+        entry->angle = params.Angle;
+        entry->deflection = params.Deflection;
+    }
+    return MeshToObject(info.Env(), entry->mesh);
+}
+
+void Document::Write(std::ostream &stream) {
+    stream.write(DocumentMagic, sizeof(DocumentMagic));
+    WriteDocumentPod(stream, nextId);
+    WriteDocumentPod(stream, (uint32_t) entries.size());
+    BRep_Builder builder;
+    TopoDS_Compound comp;
+    builder.MakeCompound(comp);
+    for (auto &[id, entry] : entries) {
+        WriteDocumentPod(stream, id);
+        WriteDocumentPod(stream, (uint32_t) entry.attrs.size());
+        for (auto &[key, val] : entry.attrs) {
+            WriteDocumentString(stream, key);
+            WriteDocumentString(stream, val);
+        }
+        WriteDocumentPod(stream, (uint8_t) ((entry.meshed ? 1 : 0) | (entry.optimized ? 2 : 0)));
+        if (entry.meshed) {
+            WriteDocumentPod(stream, entry.angle);
+            WriteDocumentPod(stream, entry.deflection);
+            WriteDocumentArray(stream, entry.mesh.positions);
+            WriteDocumentArray(stream, entry.mesh.normals);
+            WriteDocumentArray(stream, entry.mesh.indices);
+            WriteDocumentArray(stream, entry.mesh.groups);
+        }
+        builder.Add(comp, entry.shape);
+    }
+    BinTools::Write(comp, stream, Standard_True, Standard_False, BinTools_FormatVersion_CURRENT);
+}
+
+std::string Document::Read(const char *data, size_t size) {
+    DocumentReader reader { data, data + size };
+    char magic[sizeof(DocumentMagic)];
+    if (!reader.Take(magic, sizeof(magic)) || memcmp(magic, DocumentMagic, sizeof(magic))) {
+        return "not a document snapshot";
+    }
+    nextId = reader.Pod<uint32_t>();
+    auto count = reader.Pod<uint32_t>();
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < count && reader.ok; i ++) {
+        auto id = reader.Pod<uint32_t>();
+        if (reader.ok && (id >= nextId || entries.count(id))) {
+            return "document snapshot has a duplicated or invalid id " + std::to_string(id);
+        }
+        auto &entry = entries[id];
+        ids.push_back(id);
+        auto attrNum = reader.Pod<uint32_t>();
+        for (uint32_t j = 0; j < attrNum && reader.ok; j ++) {
+            auto key = reader.String();
+            entry.attrs[key] = reader.String();
+        }
+        auto flags = reader.Pod<uint8_t>();
+        entry.meshed = flags & 1;
+        entry.optimized = flags & 2;
+        if (entry.meshed) {
+            entry.angle = reader.Pod<double>();
+            entry.deflection = reader.Pod<double>();
+            reader.Array(entry.mesh.positions);
+            reader.Array(entry.mesh.normals);
+            reader.Array(entry.mesh.indices);
+            reader.Array(entry.mesh.groups);
+        }
+    }
+    if (!reader.ok) {
+        return "document snapshot is truncated";
+    }
+
+    DocumentBuf buf(reader.ptr, reader.end - reader.ptr);
+    std::istream stream(&buf);
+    TopoDS_Shape comp;
+    try {
+        BinTools::Read(comp, stream);
+    } catch (Standard_Failure &err) {
+        return std::string("document snapshot has broken shapes: ") + err.GetMessageString();
+    }
+    if (stream.fail() || comp.IsNull()) {
+        return "document snapshot has no shapes";
+    }
+    size_t i = 0;
+    for (TopoDS_Iterator it(comp, Standard_False, Standard_False); it.More() && i < ids.size(); it.Next()) {
+        entries[ids[i ++]].shape = it.Value();
+    }
+    if (i != ids.size()) {
+        return "document snapshot has " + std::to_string(i) + " shapes for " + std::to_string(ids.size()) + " entries";
+    }
+    return "";
+}
+
+Napi::Value Document::Save(const Napi::CallbackInfo &info) {
+    if (info.Length() > 0 && info[0].IsString()) {
+        std::string file = info[0].As<Napi::String>();
+        std::ofstream stream(file, std::ios::binary);
+        Write(stream);
+        if (!stream) {
+            auto msg = std::string("failed to write ") + file;
+            Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        }
+        return info.Env().Null();
+    } else {
+        std::ostringstream stream(std::ios::binary);
+        Write(stream);
+        auto str = stream.str();
+        return Napi::Buffer<char>::Copy(info.Env(), str.c_str(), str.size());
+    }
+}
+
+// the file is memory mapped and read in place, buffers may be views of SharedArrayBuffer
+Napi::Value Document::Load(const Napi::CallbackInfo &info) {
+    auto inst = GetInstanceData(info.Env()).document.New({ });
+    auto doc = Document::Unwrap(inst);
+    std::string err;
+    if (info[0].IsString()) {
+        std::string file = info[0].As<Napi::String>();
+        MappedFile mapped(file);
+        err = mapped.ok ? doc->Read(mapped.data, mapped.size) : "failed to read " + file;
+    } else if (info[0].IsTypedArray()) {
+        // the bytes of any view, not only of Uint8Array
+        auto arr = info[0].As<Napi::TypedArray>();
+        auto data = (const char *) arr.ArrayBuffer().Data() + arr.ByteOffset();
+        err = doc->Read(data, arr.ByteLength());
+    } else {
+        err = "Only file name or buffer supported";
+    }
+    if (!err.empty()) {
+        Napi::Error::New(info.Env(), err).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+    return inst;
+}
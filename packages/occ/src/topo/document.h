@@ -0,0 +1,42 @@
+#include <napi.h>
+#include <map>
+#include <string>
+#include <TopoDS_Shape.hxx>
+
+#include "../mesh/mesh.h"
+
+struct DocumentEntry {
+    TopoDS_Shape shape;
+    std::map<std::string, std::string> attrs;
+    // triangulation of the last `mesh` call, reused while the options are the same
+    bool meshed = false, optimized = false;
+    double angle = 0, deflection = 0;
+    MeshData mesh;
+};
+
+// every shape of a session under a stable integer id, with its attributes and triangulation,
+// saved and loaded as one binary snapshot
+class Document : public Napi::ObjectWrap<Document> {
+public:
+    Document(const Napi::CallbackInfo &info);
+    static void Init(Napi::Env env, Napi::Object exports);
+
+    Napi::Value Size(const Napi::CallbackInfo &info);
+    Napi::Value Ids(const Napi::CallbackInfo &info);
+    Napi::Value Add(const Napi::CallbackInfo &info);
+    Napi::Value AddParts(const Napi::CallbackInfo &info);
+    Napi::Value Remove(const Napi::CallbackInfo &info);
+    Napi::Value Get(const Napi::CallbackInfo &info);
+    Napi::Value Attrs(const Napi::CallbackInfo &info);
+    Napi::Value SetAttrs(const Napi::CallbackInfo &info);
+    Napi::Value Mesh(const Napi::CallbackInfo &info);
+    Napi::Value Save(const Napi::CallbackInfo &info);
+    static Napi::Value Load(const Napi::CallbackInfo &info);
+private:
+    std::map<uint32_t, DocumentEntry> entries;
+    uint32_t nextId = 1;
+    // throws if `info[0]` is not an id of the document
+    DocumentEntry *Find(const Napi::CallbackInfo &info);
+    void Write(std::ostream &stream);
+    std::string Read(const char *data, size_t size);
+};
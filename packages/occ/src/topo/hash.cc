@@ -0,0 +1,274 @@
+#include "hash.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <BRep_Tool.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <Geom_ConicalSurface.hxx>
+#include <Geom_SphericalSurface.hxx>
+#include <Geom_ToroidalSurface.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_SurfaceOfRevolution.hxx>
+#include <Geom_SurfaceOfLinearExtrusion.hxx>
+#include <Geom_OffsetSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Circle.hxx>
+#include <Geom_Ellipse.hxx>
+#include <Geom_Hyperbola.hxx>
+#include <Geom_Parabola.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <Geom_OffsetCurve.hxx>
+#include <Geom_TrimmedCurve.hxx>
+
+// MurmurHash3 x64 128, by Austin Appleby (public domain)
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+void Murmur3x64(const uint8_t *data, size_t len, uint64_t out[2]) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = 0, h2 = 0;
+    auto blocks = len / 16;
+    for (size_t i = 0; i < blocks; i ++) {
+        uint64_t k1, k2;
+        memcpy(&k1, data + i * 16, 8);
+        memcpy(&k2, data + i * 16 + 8, 8);
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+    auto tail = data + blocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    for (auto i = len & 15; i > 8; i --) {
+        k2 ^= (uint64_t) tail[i - 1] << ((i - 9) * 8);
+    }
+    if ((len & 15) > 8) {
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    for (auto i = std::min(len & 15, (size_t) 8); i > 0; i --) {
+        k1 ^= (uint64_t) tail[i - 1] << ((i - 1) * 8);
+    }
+    if (len & 15) {
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+    out[0] = h1;
+    out[1] = h2;
+}
+
+// serializes everything that makes up the shape into bytes, with doubles rounded to the quantum
+class ContentHasher {
+public:
+    ContentHasher(double quantum) : quantum(quantum > 0 ? quantum : 1e-6) { }
+    std::string buf;
+
+    void Int(int64_t v) {
+        buf.append((const char *) &v, sizeof(v));
+    }
+    void Real(double v) {
+        // llround is undefined out of the int64 range, a tiny quantum or huge value would get there
+        auto q = v / quantum;
+        const double limit = 9.2e18;
+        Int(std::isnan(q) ? INT64_MIN : q >= limit ? INT64_MAX : q <= -limit ? INT64_MIN : (int64_t) std::llround(q));
+    }
+    void Name(const Handle(Standard_Transient) &obj) {
+        buf.append(obj->DynamicType()->Name());
+        buf.push_back(0);
+    }
+    void Xyz(const gp_XYZ &p) {
+        Real(p.X()); Real(p.Y()); Real(p.Z());
+    }
+    void Ax2(const gp_Ax2 &ax) {
+        Xyz(ax.Location().XYZ()); Xyz(ax.Direction().XYZ()); Xyz(ax.XDirection().XYZ());
+    }
+    void Ax3(const gp_Ax3 &ax) {
+        Xyz(ax.Location().XYZ()); Xyz(ax.Direction().XYZ()); Xyz(ax.XDirection().XYZ());
+    }
+    template <typename T>
+    void Reals(const T &arr) {
+        Int(arr.Length());
+        for (auto i = arr.Lower(); i <= arr.Upper(); i ++) Real(arr(i));
+    }
+    template <typename T>
+    void Grid(const T &arr) {
+        for (auto i = arr.LowerRow(); i <= arr.UpperRow(); i ++) {
+            for (auto j = arr.LowerCol(); j <= arr.UpperCol(); j ++) {
+                Value(arr(i, j));
+            }
+        }
+    }
+    void Value(const gp_Pnt &p) {
+        Xyz(p.XYZ());
+    }
+    void Value(double v) {
+        Real(v);
+    }
+    template <typename T>
+    void Ints(const T &arr) {
+        Int(arr.Length());
+        for (auto i = arr.Lower(); i <= arr.Upper(); i ++) Int(arr(i));
+    }
+
+    void Curve(Handle(Geom_Curve) curve) {
+        if (curve.IsNull()) {
+            Int(-1);
+            return;
+        }
+        while (auto trimmed = Handle(Geom_TrimmedCurve)::DownCast(curve)) {
+            curve = trimmed->BasisCurve();
+        }
+        Name(curve);
+        if (auto c = Handle(Geom_Line)::DownCast(curve)) {
+            Xyz(c->Position().Location().XYZ()); Xyz(c->Position().Direction().XYZ());
+        } else if (auto c = Handle(Geom_Circle)::DownCast(curve)) {
+            Ax2(c->Position()); Real(c->Radius());
+        } else if (auto c = Handle(Geom_Ellipse)::DownCast(curve)) {
+            Ax2(c->Position()); Real(c->MajorRadius()); Real(c->MinorRadius());
+        } else if (auto c = Handle(Geom_Hyperbola)::DownCast(curve)) {
+            Ax2(c->Position()); Real(c->MajorRadius()); Real(c->MinorRadius());
+        } else if (auto c = Handle(Geom_Parabola)::DownCast(curve)) {
+            Ax2(c->Position()); Real(c->Focal());
+        } else if (auto c = Handle(Geom_BSplineCurve)::DownCast(curve)) {
+            Int(c->Degree()); Int(c->IsPeriodic());
+            Int(c->NbPoles());
+            for (auto i = 1; i <= c->NbPoles(); i ++) Xyz(c->Pole(i).XYZ());
+            if (c->IsRational()) Reals(*c->Weights());
+            Reals(c->Knots()); Ints(c->Multiplicities());
+        } else if (auto c = Handle(Geom_BezierCurve)::DownCast(curve)) {
+            Int(c->NbPoles());
+            for (auto i = 1; i <= c->NbPoles(); i ++) Xyz(c->Pole(i).XYZ());
+            if (c->IsRational()) Reals(*c->Weights());
+        } else if (auto c = Handle(Geom_OffsetCurve)::DownCast(curve)) {
+            Real(c->Offset()); Xyz(c->Direction().XYZ()); Curve(c->BasisCurve());
+        }
+    }
+
+    void Surface(Handle(Geom_Surface) surf) {
+        if (surf.IsNull()) {
+            Int(-1);
+            return;
+        }
+        while (auto trimmed = Handle(Geom_RectangularTrimmedSurface)::DownCast(surf)) {
+            surf = trimmed->BasisSurface();
+        }
+        Name(surf);
+        if (auto s = Handle(Geom_Plane)::DownCast(surf)) {
+            Ax3(s->Position());
+        } else if (auto s = Handle(Geom_CylindricalSurface)::DownCast(surf)) {
+            Ax3(s->Position()); Real(s->Radius());
+        } else if (auto s = Handle(Geom_ConicalSurface)::DownCast(surf)) {
+            Ax3(s->Position()); Real(s->RefRadius()); Real(s->SemiAngle());
+        } else if (auto s = Handle(Geom_SphericalSurface)::DownCast(surf)) {
+            Ax3(s->Position()); Real(s->Radius());
+        } else if (auto s = Handle(Geom_ToroidalSurface)::DownCast(surf)) {
+            Ax3(s->Position()); Real(s->MajorRadius()); Real(s->MinorRadius());
+        } else if (auto s = Handle(Geom_BSplineSurface)::DownCast(surf)) {
+            Int(s->UDegree()); Int(s->VDegree()); Int(s->IsUPeriodic()); Int(s->IsVPeriodic());
+            Int(s->NbUPoles()); Int(s->NbVPoles());
+            Grid(s->Poles());
+            if (s->IsURational() || s->IsVRational()) Grid(*s->Weights());
+            Reals(s->UKnots()); Ints(s->UMultiplicities());
+            Reals(s->VKnots()); Ints(s->VMultiplicities());
+        } else if (auto s = Handle(Geom_BezierSurface)::DownCast(surf)) {
+            Int(s->NbUPoles()); Int(s->NbVPoles());
+            Grid(s->Poles());
+            if (s->IsURational() || s->IsVRational()) Grid(*s->Weights());
+        } else if (auto s = Handle(Geom_SurfaceOfRevolution)::DownCast(surf)) {
+            Xyz(s->Location().XYZ()); Xyz(s->Direction().XYZ()); Curve(s->BasisCurve());
+        } else if (auto s = Handle(Geom_SurfaceOfLinearExtrusion)::DownCast(surf)) {
+            Xyz(s->Direction().XYZ()); Curve(s->BasisCurve());
+        } else if (auto s = Handle(Geom_OffsetSurface)::DownCast(surf)) {
+            Real(s->Offset()); Surface(s->BasisSurface());
+        }
+    }
+
+    // the tree down to faces, faces and edges are written once and referred to by index
+    void Tree(const TopoDS_Shape &shape) {
+        Int(shape.ShapeType());
+        Int(shape.Orientation());
+        if (shape.ShapeType() == TopAbs_FACE) {
+            Int(faces.FindIndex(shape));
+            return;
+        }
+        Int(shape.NbChildren());
+        for (TopoDS_Iterator it(shape); it.More(); it.Next()) {
+            Tree(it.Value());
+        }
+    }
+
+    void Hash(const TopoDS_Shape &shape) {
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+        TopExp::MapShapes(shape, TopAbs_EDGE, edges);
+        TopExp::MapShapes(shape, TopAbs_VERTEX, verts);
+        Tree(shape);
+
+        Int(verts.Extent());
+        for (int i = 1; i <= verts.Extent(); i ++) {
+            auto &vert = TopoDS::Vertex(verts(i));
+            Xyz(BRep_Tool::Pnt(vert).XYZ());
+            Real(BRep_Tool::Tolerance(vert));
+        }
+        Int(edges.Extent());
+        for (int i = 1; i <= edges.Extent(); i ++) {
+            auto &edge = TopoDS::Edge(edges(i));
+            double first = 0, last = 0;
+            Curve(BRep_Tool::Curve(edge, first, last));
+            Real(first); Real(last);
+            Real(BRep_Tool::Tolerance(edge));
+            Int(BRep_Tool::Degenerated(edge));
+            for (TopoDS_Iterator it(edge); it.More(); it.Next()) {
+                Int(verts.FindIndex(it.Value()));
+                Int(it.Value().Orientation());
+            }
+        }
+        Int(faces.Extent());
+        for (int i = 1; i <= faces.Extent(); i ++) {
+            auto &face = TopoDS::Face(faces(i));
+            Surface(BRep_Tool::Surface(face));
+            Real(BRep_Tool::Tolerance(face));
+            for (TopoDS_Iterator wire(face); wire.More(); wire.Next()) {
+                Int(wire.Value().Orientation());
+                Int(wire.Value().NbChildren());
+                for (TopoDS_Iterator it(wire.Value()); it.More(); it.Next()) {
+                    Int(edges.FindIndex(it.Value()));
+                    Int(it.Value().Orientation());
+                }
+            }
+        }
+    }
+private:
+    double quantum;
+    TopTools_IndexedMapOfShape faces, edges, verts;
+};
+
+std::string ContentHash(const TopoDS_Shape &shape, double quantum) {
+    ContentHasher hasher(quantum);
+    hasher.Hash(shape);
+    uint64_t out[2];
+    Murmur3x64((const uint8_t *) hasher.buf.data(), hasher.buf.size(), out);
+    char hex[33];
+    snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long) out[0], (unsigned long long) out[1]);
+    return hex;
+}
@@ -0,0 +1,5 @@
+#include <string>
+#include <TopoDS_Shape.hxx>
+
+// 128 bit hex digest of the topology and geometry rounded to `quantum`, stable across sessions and re-imports
+std::string ContentHash(const TopoDS_Shape &shape, double quantum);
@@ -8,6 +8,9 @@
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Wire.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <gp_Trsf.hxx>
+#include <gp_Vec.hxx>
 
 #include <Geom_BSplineSurface.hxx>
 #include <Geom_BSplineCurve.hxx>
@@ -18,6 +21,7 @@
 #include <BRepGProp.hxx>
 
 #include "../utils.h"
+#include "hash.h"
 
 std::map<int, std::map<std::string, std::string>> Shape::MetaMap;
 
@@ -30,14 +34,20 @@ void Shape::Init(Napi::Env env, Napi::Object exports) {
         InstanceAccessor("meta", &Shape::Meta, NULL),
         InstanceMethod("bound", &Shape::Bound),
         InstanceMethod("find", &Shape::Find),
+        InstanceMethod("moved", &Shape::Moved),
 
         InstanceMethod("getLinearProps", &Shape::GetLinearProps),
         InstanceMethod("getSurfaceProps", &Shape::GetSurfaceProps),
         InstanceMethod("getVolumeProps", &Shape::GetVolumeProps),
+        InstanceMethod("contentHash", &Shape::ContentHash),
+
+        InstanceMethod("share", &Shape::Share),
+        StaticMethod("fromShared", &Shape::FromShared),
+        StaticMethod("releaseShared", &Shape::ReleaseShared),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    // the constructor lives in per-environment data, so every worker thread gets its own
+    GetInstanceData(env).shape = Napi::Persistent(func);
 
     auto types = Napi::Object::New(env);
     types.Set("COMPOUND", Napi::Number::New(env, TopAbs_ShapeEnum::TopAbs_COMPOUND));
@@ -60,14 +70,32 @@ Napi::Value Shape::Type(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value Shape::Meta(const Napi::CallbackInfo &info) {
-    auto &meta = Shape::MetaMap[shape.HashCode(0x0fffffff)];
     auto ret = Napi::Object::New(info.Env());
-    for (auto &[key, val] : meta) {
+    if (meta) {
+        for (auto &[key, val] : *meta) {
+            ret.Set(key, val);
+        }
+        return ret;
+    }
+    std::lock_guard<std::mutex> lock(Shape::MetaMutex);
+    auto &found = Shape::MetaMap[shape.HashCode(0x0fffffff)];
+    for (auto &[key, val] : found) {
         ret.Set(key, val);
     }
     return ret;
 }
 
+// a located copy sharing the TShape, like an instance of a step assembly
+Napi::Value Shape::Moved(const Napi::CallbackInfo &info) {
+    auto offset = obj2pt(info[0]);
+    if (info.Env().IsExceptionPending()) {
+        return info.Env().Undefined();
+    }
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(offset.XYZ()));
+    return Shape::Create(info.Env(), shape.Moved(TopLoc_Location(trsf)));
+}
+
 Napi::Value Shape::Bound(const Napi::CallbackInfo &info) {
     Bnd_Box box;
     BRepBndLib::Add(shape, box);
@@ -100,7 +128,7 @@ Napi::Value Shape::Find(const Napi::CallbackInfo &info) {
         auto hash = topo.HashCode(0x0fffffff);
         if (!added.count(hash)) {
             added.insert(hash);
-            arr.Set(i ++, Shape::Create(topo));
+            arr.Set(i ++, Shape::Create(info.Env(), topo));
         }
     }
     return arr;
@@ -130,10 +158,49 @@ Napi::Value Shape::GetVolumeProps(const Napi::CallbackInfo &info) {
     return ret;
 }
 
-Napi::Value Shape::Create(const TopoDS_Shape &shape) {
-    auto inst = constructor.New({ });
+Napi::Value Shape::ContentHash(const Napi::CallbackInfo &info) {
+    double quantum = 1e-6;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        auto opts = info[0].As<Napi::Object>();
+        if (opts.Has("quantum")) {
+            quantum = opts.Get("quantum").As<Napi::Number>().DoubleValue();
+        }
+    }
+    return Napi::String::New(info.Env(), ::ContentHash(shape, quantum));
+}
+
+Napi::Value Shape::Share(const Napi::CallbackInfo &info) {
+    std::lock_guard<std::mutex> lock(SharedMutex);
+    auto id = ++ SharedCount;
+    SharedMap[id] = shape;
+    return Napi::Number::New(info.Env(), (double) id);
+}
+
+Napi::Value Shape::FromShared(const Napi::CallbackInfo &info) {
+    auto id = info[0].As<Napi::Number>().Int64Value();
+    std::lock_guard<std::mutex> lock(SharedMutex);
+    auto found = SharedMap.find(id);
+    if (found == SharedMap.end()) {
+        auto msg = std::string("shared shape ") + std::to_string(id) + " not found";
+        Napi::Error::New(info.Env(), msg).ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+    return Shape::Create(info.Env(), found->second);
+}
+
+Napi::Value Shape::ReleaseShared(const Napi::CallbackInfo &info) {
+    auto id = info[0].As<Napi::Number>().Int64Value();
+    std::lock_guard<std::mutex> lock(SharedMutex);
+    return Napi::Boolean::New(info.Env(), SharedMap.erase(id) > 0);
+}
+
+Napi::Value Shape::Create(Napi::Env env, const TopoDS_Shape &shape) {
+    auto inst = GetInstanceData(env).shape.New({ });
     Shape::Unwrap(inst)->shape = shape;
     return inst;
 }
 
-Napi::FunctionReference Shape::constructor;
+std::mutex Shape::MetaMutex;
+std::mutex Shape::SharedMutex;
+std::map<int64_t, TopoDS_Shape> Shape::SharedMap;
+int64_t Shape::SharedCount = 0;
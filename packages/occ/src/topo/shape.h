@@ -1,24 +1,38 @@
 #include <napi.h>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <TopoDS.hxx>
 
 class Shape : public Napi::ObjectWrap<Shape> {
 public:
     static std::map<int, std::map<std::string, std::string>> MetaMap;
+    static std::mutex MetaMutex;
     Shape(const Napi::CallbackInfo &info);
     static void Init(Napi::Env env, Napi::Object exports);
-    static Napi::Value Create(const TopoDS_Shape &shape);
+    static Napi::Value Create(Napi::Env env, const TopoDS_Shape &shape);
 
     TopoDS_Shape shape;
+    // meta of this wrapper only, like the attributes of `Document.get`, used instead of MetaMap when set
+    std::unique_ptr<std::map<std::string, std::string>> meta;
     Napi::Value Type(const Napi::CallbackInfo &info);
     Napi::Value Meta(const Napi::CallbackInfo &info);
     Napi::Value Bound(const Napi::CallbackInfo &info);
     Napi::Value Find(const Napi::CallbackInfo &info);
+    Napi::Value Moved(const Napi::CallbackInfo &info);
 
     Napi::Value GetLinearProps(const Napi::CallbackInfo &info);
     Napi::Value GetSurfaceProps(const Napi::CallbackInfo &info);
     Napi::Value GetVolumeProps(const Napi::CallbackInfo &info);
+    Napi::Value ContentHash(const Napi::CallbackInfo &info);
+
+    // shapes are shared between worker threads by handle, the TShape itself is not copied
+    Napi::Value Share(const Napi::CallbackInfo &info);
+    static Napi::Value FromShared(const Napi::CallbackInfo &info);
+    static Napi::Value ReleaseShared(const Napi::CallbackInfo &info);
 private:
-    static Napi::FunctionReference constructor;
+    static std::mutex SharedMutex;
+    static std::map<int64_t, TopoDS_Shape> SharedMap;
+    static int64_t SharedCount;
 };
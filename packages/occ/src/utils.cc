@@ -1,7 +1,43 @@
 #include "utils.h"
 
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void DeleteInstanceData(napi_env env, void *data, void *hint) {
+    delete static_cast<InstanceData *>(data);
+}
+
+void SetInstanceData(Napi::Env env) {
+    if (napi_set_instance_data(env, new InstanceData(), DeleteInstanceData, nullptr) != napi_ok) {
+        Napi::Error::New(env, "failed to set instance data").ThrowAsJavaScriptException();
+    }
+}
+
+InstanceData &GetInstanceData(Napi::Env env) {
+    void *data = nullptr;
+    napi_get_instance_data(env, &data);
+    return *static_cast<InstanceData *>(data);
+}
+
 gp_Pnt obj2pt(Napi::Value val) {
-    if (val.IsArray()) {
+    if (val.IsTypedArray()) {
+        auto arr = toDoubleArr(val);
+        if (arr.size() < 3) {
+            Napi::TypeError::New(val.Env(), "point should have 3 coordinates").ThrowAsJavaScriptException();
+            return gp_Pnt();
+        }
+        return gp_Pnt(arr[0], arr[1], arr[2]);
+    } else if (val.IsArray()) {
         auto arr = val.As<Napi::Array>();
         return gp_Pnt(
             arr.Get((uint32_t) 0).As<Napi::Number>().DoubleValue(),
@@ -18,8 +54,30 @@ gp_Pnt obj2pt(Napi::Value val) {
     }
 }
 
+template <typename T>
+void assignTypedArr(Napi::Value arr, std::vector<double> &ret) {
+    auto list = arr.As<Napi::TypedArrayOf<T>>();
+    ret.assign(list.Data(), list.Data() + list.ElementLength());
+}
+
 std::vector<double> toDoubleArr(Napi::Value arr) {
     std::vector<double> ret;
+    if (arr.IsTypedArray()) {
+        switch (arr.As<Napi::TypedArray>().TypedArrayType()) {
+            case napi_float64_array: assignTypedArr<double>(arr, ret); break;
+            case napi_float32_array: assignTypedArr<float>(arr, ret); break;
+            case napi_int32_array: assignTypedArr<int32_t>(arr, ret); break;
+            case napi_uint32_array: assignTypedArr<uint32_t>(arr, ret); break;
+            case napi_int16_array: assignTypedArr<int16_t>(arr, ret); break;
+            case napi_uint16_array: assignTypedArr<uint16_t>(arr, ret); break;
+            case napi_int8_array: assignTypedArr<int8_t>(arr, ret); break;
+            case napi_uint8_array: assignTypedArr<uint8_t>(arr, ret); break;
+            case napi_uint8_clamped_array: assignTypedArr<uint8_t>(arr, ret); break;
+            default:
+                Napi::TypeError::New(arr.Env(), "expect a number array").ThrowAsJavaScriptException();
+        }
+        return ret;
+    }
     auto list = arr.As<Napi::Array>();
     for (uint32_t i = 0; i < list.Length(); i ++) {
         ret.push_back(list.Get(i).As<Napi::Number>().DoubleValue());
@@ -27,6 +85,20 @@ std::vector<double> toDoubleArr(Napi::Value arr) {
     return ret;
 }
 
+std::vector<double> toCellCenters(const std::vector<double> &lines) {
+    std::vector<double> ret;
+    for (size_t i = 0; i + 1 < lines.size(); i ++) {
+        ret.push_back((lines[i] + lines[i + 1]) / 2);
+    }
+    return ret;
+}
+
+std::pair<size_t, size_t> GetCellRange(const std::vector<double> &sorted, double min, double max) {
+    auto begin = std::lower_bound(sorted.begin(), sorted.end(), min) - sorted.begin();
+    auto end = std::upper_bound(sorted.begin(), sorted.end(), max) - sorted.begin();
+    return std::make_pair((size_t) begin, (size_t) std::max(begin, end));
+}
+
 Napi::Object pt2obj(Napi::Env env, gp_Pnt &pt) {
     auto obj = Napi::Object::New(env);
     obj.Set("x", Napi::Number::New(env, pt.X()));
@@ -34,3 +106,51 @@ Napi::Object pt2obj(Napi::Env env, gp_Pnt &pt) {
     obj.Set("z", Napi::Number::New(env, pt.Z()));
     return obj;
 }
+
+MappedFile::MappedFile(const std::string &path) {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER len;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &len)) {
+        return;
+    }
+    size = (size_t) len.QuadPart;
+    if (size > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        data = mapping ? (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+#else
+    fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        return;
+    }
+    size = (size_t) st.st_size;
+    if (size > 0) {
+        auto ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        data = ptr != MAP_FAILED ? (const char *) ptr : nullptr;
+    }
+#endif
+    ok = size == 0 || data != nullptr;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file && file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+#else
+    if (data) {
+        munmap((void *) data, size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+}
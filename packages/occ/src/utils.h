@@ -1,6 +1,38 @@
+#pragma once
 #include <napi.h>
+#include <string>
+#include <vector>
 #include <gp_Pnt.hxx>
+#include <Standard_Version.hxx>
+
+#if OCC_VERSION_HEX < 0x070600
+#error "OCCT 7.6 or later is required"
+#endif
+
+// state owned by one js environment, the addon may be loaded in several worker threads
+struct InstanceData {
+    Napi::FunctionReference shape, document;
+};
+void SetInstanceData(Napi::Env env);
+InstanceData &GetInstanceData(Napi::Env env);
 
 gp_Pnt obj2pt(Napi::Value obj);
 Napi::Object pt2obj(Napi::Env env, gp_Pnt &pt);
+// read only view of a whole file, pages are only loaded when touched
+class MappedFile {
+public:
+    const char *data = nullptr;
+    size_t size = 0;
+    bool ok = false;
+    MappedFile(const std::string &path);
+    ~MappedFile();
+private:
+    // HANDLEs of the file and its mapping on windows, the descriptor otherwise
+    void *file = nullptr, *mapping = nullptr;
+    int fd = -1;
+};
+
 std::vector<double> toDoubleArr(Napi::Value arr);
+std::vector<double> toCellCenters(const std::vector<double> &lines);
+// indices [begin, end) of the sorted values inside [min, max]
+std::pair<size_t, size_t> GetCellRange(const std::vector<double> &sorted, double min, double max);
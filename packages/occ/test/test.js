@@ -1,5 +1,6 @@
 const assert = require('assert'),
-    { brep, step, tool, Shape, mesh } = require('../'),
+    { Worker } = require('worker_threads'),
+    { brep, step, tool, Shape, Document, mesh } = require('../'),
     { bool, builder, primitive } = brep
 
 describe('shape', () => {
@@ -11,6 +12,20 @@ describe('shape', () => {
         })
     })
 
+    it('shape.contentHash', () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            b2 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            b3 = primitive.makeBox([0, 0, 0], [1, 1, 2])
+        assert.equal(b1.contentHash().length, 32)
+        assert.equal(b1.contentHash(), b2.contentHash())
+        assert.notEqual(b1.contentHash(), b3.contentHash())
+
+        // stable over a round trip, and a moved copy is a different shape
+        assert.equal(brep.load(brep.save(b1)).contentHash(), b1.contentHash())
+        assert.equal(brep.load(brep.save(b1, { binary: true })).contentHash(), b1.contentHash())
+        assert.notEqual(primitive.makeBox([1, 0, 0], [2, 1, 1]).contentHash(), b1.contentHash())
+        assert.equal(b1.contentHash({ quantum: 1e-300 }).length, 32)
+    })
     it('shape.getSurfaceProps', () => {
         const b1 = primitive.makeBox([0, 0, 0], [1, 2, 3]),
             [f1] = b1.find(Shape.types.FACE)
@@ -18,6 +33,60 @@ describe('shape', () => {
     })
 })
 
+describe('document', () => {
+    it('document.save', () => {
+        const doc = new Document(),
+            comp = primitive.makeBoxes(new Float64Array([0, 0, 0, 1, 1, 1, 2, 2, 2, 4, 4, 4]), { compound: true }),
+            [a, b] = doc.addParts(comp, Shape.types.SOLID),
+            c = doc.add(primitive.makeSphere([0, 0, 0], 1), { name: 'ball' })
+        doc.setAttrs(a, { name: 'small' })
+        doc.remove(b)
+        const { indices } = doc.mesh(c, { deflection: 0.1 }),
+            copy = Document.load(doc.save())
+        assert.deepEqual(Array.from(copy.ids()), [a, c])
+        assert.equal(copy.get(a).meta.name, 'small')
+        assert.ok(Math.abs(copy.get(a).getVolumeProps().mass - 1) < 1e-9)
+        assert.deepEqual(copy.mesh(c, { deflection: 0.1 }).indices, indices)
+        assert.equal(copy.add(copy.get(c)), c + 1)
+        // attributes stay on the wrapper from get
+        assert.equal(copy.get(a).meta.name, 'small')
+        assert.equal(copy.get(a).find(Shape.types.SOLID)[0].meta.name, undefined)
+    })
+    it('document.load checks snapshots', () => {
+        const doc = new Document()
+        doc.add(primitive.makeBox([0, 0, 0], [1, 1, 1]))
+        const buf = doc.save(),
+            view = new Uint8Array(buf.length + 8)
+        view.set(buf, 8)
+        assert.deepEqual(Array.from(Document.load(view.subarray(8)).ids()), Array.from(doc.ids()))
+        assert.throws(() => Document.load(buf.slice(0, buf.length - 16)))
+        const broken = Buffer.from(buf)
+        broken.writeUInt32LE(0, 8)
+        assert.throws(() => Document.load(broken), /invalid id/)
+    })
+})
+
+describe('worker', () => {
+    it('should load in worker threads and open shared shapes', async () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            handle = b1.share(),
+            script = `
+                const { parentPort, workerData } = require('worker_threads'),
+                    { Shape } = require(${JSON.stringify(require.resolve('../'))}),
+                    shape = Shape.fromShared(workerData)
+                parentPort.postMessage(shape.find(Shape.types.FACE).length)
+            `,
+            counts = await Promise.all([0, 1].map(() => new Promise((resolve, reject) => {
+                const worker = new Worker(script, { eval: true, workerData: handle })
+                worker.once('message', resolve)
+                worker.once('error', reject)
+            })))
+        assert.deepEqual(counts, [6, 6])
+        assert.equal(Shape.releaseShared(handle), true)
+        assert.throws(() => Shape.fromShared(handle))
+    })
+})
+
 describe('brep', () => {
     it('should save and load brep files', () => {
         const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1])
@@ -31,11 +100,27 @@ describe('brep', () => {
         assert.equal(b2.type, b3.type)
     })
 
+    it('should save and load binary brep', () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            buf = brep.save(b1, { binary: true }),
+            shared = new Uint8Array(new SharedArrayBuffer(buf.length))
+        shared.set(buf)
+        const b2 = brep.load(shared, { binary: true })
+        assert.equal(b2.find(Shape.types.FACE).length, 6)
+        assert.throws(() => brep.load(buf.subarray(0, buf.length / 2), { binary: true }))
+        assert.throws(() => brep.load(new Float32Array(4), { binary: true }))
+    })
+
     describe('brep.builder', () => {
         it('should make edge', () => {
             const edge = builder.makeEdge([0, 0, 0], [0, 0, 1])
             assert.equal(edge.type, Shape.types.EDGE)
         })
+        it('should make polyline', () => {
+            const wire = builder.makePolyline(new Float64Array([0, 0, 0, 1, 0, 0, 1, 1, 0]), true)
+            assert.equal(wire.type, Shape.types.WIRE)
+            assert.equal(wire.find(Shape.types.EDGE).length, 3)
+        })
         it('should make face', () => {
             const face = builder.makeFace([0, 0, 0], [1, 1, 1])
             assert.equal(face.type, Shape.types.FACE)
@@ -56,6 +141,20 @@ describe('brep', () => {
             assert.equal(sphere.find(Shape.types.WIRE).length, 1)
             assert.equal(sphere.find(Shape.types.EDGE).length, 3)
         })
+        it('should make boxes and spheres in batch', () => {
+            const boxes = primitive.makeBoxes(new Float64Array([0, 0, 0, 1, 1, 1, 1, 1, 1, 3, 3, 3]))
+            assert.equal(boxes.length, 2)
+            assert.equal(boxes[1].getVolumeProps().mass, 8)
+            const comp = primitive.makeSpheres(new Float64Array([0, 0, 0, 1, 5, 0, 0, 1, 10, 0, 0, 1]), { compound: true })
+            assert.equal(comp.type, Shape.types.COMPOUND)
+            assert.equal(comp.find(Shape.types.SOLID).length, 3)
+            assert.equal(primitive.makeBoxes(new Int32Array([0, 0, 0, 1, 2, 3]))[0].getVolumeProps().mass, 6)
+            assert.throws(() => primitive.makeBox(new Float64Array([0, 0]), [1, 1, 1]))
+            // bad sizes are js errors instead of aborting the process
+            assert.throws(() => primitive.makeBoxes(new Float64Array([0, 0, 0, 1, 0, 1])), /makeBoxes/)
+            assert.throws(() => primitive.makeSpheres(new Float64Array([0, 0, 0, 1, 0, 0, 0, -1])), /makeSpheres item 1/)
+            assert.throws(() => primitive.makeSphere([0, 0, 0], 0), /makeSphere/)
+        })
         it('should make boxes', () => {
             const box = primitive.makeBox([0, 0, 0], [1, 1, 1])
             assert.equal(box.find(Shape.types.FACE).length, 6)
@@ -84,10 +183,34 @@ describe('brep', () => {
             const ret = bool.cut([b1], [b2])
             assert.equal(ret.find(Shape.types.FACE).length, 9)
         })
+        it('should return history', () => {
+            const { shape, history } = bool.cut([b1], [b2], { history: true }),
+                [args, tools] = history
+            assert.equal(shape.find(Shape.types.FACE).length, 9)
+            assert.deepEqual(Array.from(args.status).sort(), [0, 0, 0, 1, 1, 1])
+            assert.deepEqual(Array.from(tools.status).sort(), [1, 1, 1, 4, 4, 4])
+            assert.equal(args.offsets[6], args.faces.length)
+            assert.ok(Array.from(args.faces).every(idx => idx < 9))
+        })
         it('should work with split', () => {
             const ret = bool.split([b1], [b2])
             assert.equal(ret.find(Shape.types.FACE).length, 12)
         })
+        it('should stop with signal', () => {
+            const signal = new Int32Array(new SharedArrayBuffer(4))
+            Atomics.store(signal, 0, 1)
+            assert.throws(() => bool.fuse([b1], [b2], { signal }), /aborted/)
+            assert.throws(() => mesh.create(b1, { signal }), /aborted/)
+        })
+        it('should partition bodies with generalFuse', () => {
+            const b1 = primitive.makeBox([0, 0, 0], [2, 2, 2]),
+                b2 = primitive.makeBox([1, 1, 1], [3, 3, 3]),
+                ret = bool.generalFuse([b1, b2], { parallel: true }),
+                solids = ret.shape.find(Shape.types.SOLID),
+                owners = solids.map((_, i) => Array.from(ret.bodies.slice(ret.offsets[i], ret.offsets[i + 1])))
+            assert.equal(solids.length, 3)
+            assert.deepEqual(owners.map(list => list.join()).sort(), ['0', '0,1', '1'])
+        })
     })
 })
 
@@ -98,6 +221,15 @@ describe('step', () => {
         const b2 = step.load('build/box.stp')
         assert.equal(b2.type, b1.type)
     })
+    it('should stream step roots', () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1])
+        step.save('build/stream.stp', b1)
+        const shapes = [ ],
+            ret = step.stream('build/stream.stp', (shape, root) => shapes.push(root), { batch: 1 })
+        assert.equal(ret.roots, 1)
+        assert.deepEqual(shapes, [0])
+        assert.ok(ret.memoryGrowth >= 0)
+    })
 })
 
 describe('tool', () => {
@@ -112,6 +244,65 @@ describe('tool', () => {
             { i: 0, j: 2, k: 2, s: 0.010000000000000018 }
         ])
     })
+    it('tool.voxelize', () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            b2 = primitive.makeBox([0, 0, 0.9], [2, 2, 2]),
+            lines = [-0.5, 0.25, 0.75, 1.5],
+            grid = tool.voxelize([b1, b2], lines, lines, lines)
+        assert.equal(grid.length, 27)
+        assert.deepEqual(Array.from(grid).map((v, i) => v && [i, v]).filter(v => v), [
+            [13, 1],
+            [22, 2], [23, 2], [25, 2], [26, 2],
+        ])
+    })
+    it('tool.slices', () => {
+        const b1 = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            { positions, loops, closed, planes, failed } = tool.slices(b1, 2, [0.5, 2, 0.25])
+        assert.deepEqual(Array.from(planes), [0, 1, 1, 2])
+        assert.deepEqual(Array.from(failed), [0, 0, 0])
+        assert.deepEqual(Array.from(closed), [1, 1])
+        assert.equal(loops[2] * 3, positions.length)
+        assert.equal(positions[2], 0.5)
+        assert.equal(positions[loops[1] * 3 + 2], 0.25)
+    })
+    it('tool.conformal', () => {
+        const b1 = primitive.makeBox([0.25, 0.5, 0.5], [2, 2, 2]),
+            lines = [0, 1, 2],
+            { lx, sx, sz } = tool.conformal([b1], lines, lines, lines),
+            at = (i, j, k) => i + 3 * (j + 3 * k)
+        assert.equal(lx.length, 27)
+        assert.ok(Math.abs(lx[at(0, 1, 1)] - 0.75) < 1e-6)
+        assert.ok(Math.abs(sx[at(1, 0, 0)] - 0.25) < 1e-6)
+        assert.ok(Math.abs(sz[at(0, 0, 1)] - 0.375) < 1e-6)
+        assert.equal(sx[at(0, 0, 0)], 0)
+    })
+    it('tool.classify', () => {
+        const shapes = primitive.makeBoxes(new Float64Array([0, 0, 0, 2, 2, 2, 1, 1, 1, 3, 3, 3])),
+            points = new Float64Array([0.5, 0.5, 0.5, 1.5, 1.5, 1.5, 2.5, 2.5, 2.5, 5, 5, 5])
+        assert.deepEqual(Array.from(tool.classify(shapes, points)), [1, 2, 2, 0])
+        assert.deepEqual(Array.from(tool.classify(shapes, points, { mesh: true })), [1, 2, 2, 0])
+        assert.throws(() => tool.classify(shapes, Array.from(points)), TypeError)
+
+        // positions above 255 need a wider array
+        const many = primitive.makeBoxes(new Float64Array(256 * 6).map((_, i) => [2, 0, 0, 2, 0, 0][i % 6] * Math.floor(i / 6) + (i % 6 < 3 ? 0 : 1))),
+            last = tool.classify(many, new Float64Array([255 * 2 + 0.5, 0.5, 0.5]))
+        assert.ok(last instanceof Uint16Array)
+        assert.equal(last[0], 256)
+    })
+    it('tool.clearance', () => {
+        const shapes = primitive.makeBoxes(new Float64Array([
+                0, 0, 0, 1, 1, 1,
+                0.5, 0.5, 0.5, 1.5, 1.5, 1.5,
+                3, 0, 0, 4, 1, 1,
+            ])),
+            touching = tool.clearance(shapes),
+            near = tool.clearance(shapes, { maxDistance: 2.5 })
+        assert.deepEqual(Array.from(touching.pairs), [0, 1])
+        assert.deepEqual(Array.from(touching.overlaps), [1])
+        assert.deepEqual(Array.from(near.pairs), [0, 1, 0, 2, 1, 2])
+        assert.ok(Math.abs(near.distances[1] - 2) < 1e-6)
+        assert.ok(Math.abs(near.distances[2] - 1.5) < 1e-6)
+    })
 })
 
 describe('mesh', () => {
@@ -128,6 +319,210 @@ describe('mesh', () => {
         assert.equal(ret.positions.length, 72)
         assert.equal(ret.indices.length, 36)
     })
+    it('mesh.create with optimize', () => {
+        const s = bool.fuse([primitive.makeBox([0, 0, 0], [1, 1, 1])], [primitive.makeSphere([1, 1, 1], 0.5)]),
+            a = mesh.create(s, { deflection: 0.01 }),
+            b = mesh.create(s, { deflection: 0.01, optimize: true })
+        assert.equal(b.indices.length, a.indices.length)
+        assert.equal(b.positions.length, a.positions.length)
+        assert.deepEqual(Array.from(b.groups), Array.from(a.groups))
+        assert.equal(b.indices[0], 0)
+
+        // the same triangles with the same winding, only reordered within each face group
+        const triangles = ({ positions, indices, groups }) => {
+            const ret = [ ]
+            for (let t = 0; t < indices.length; t += 3) {
+                const verts = Array.from(indices.slice(t, t + 3)).map(v => positions.slice(v * 3, v * 3 + 3).join()),
+                    k = verts.indexOf(verts.slice().sort()[0])
+                ret.push(groups[t] + ':' + verts.slice(k).concat(verts.slice(0, k)).join(';'))
+            }
+            return ret.sort()
+        }
+        assert.deepEqual(triangles(b), triangles(a))
+
+        // average cache miss ratio of a 16 entry fifo vertex cache
+        const acmr = ({ indices }) => {
+            const cache = [ ]
+            let misses = 0
+            for (const v of indices) {
+                if (!cache.includes(v)) {
+                    misses ++
+                    cache.push(v)
+                    cache.length > 16 && cache.shift()
+                }
+            }
+            return misses / (indices.length / 3)
+        }
+        const before = acmr(a), after = acmr(b)
+        assert.ok(after < before, `acmr ${after} is not below ${before}`)
+    })
+    it('mesh.batch', async () => {
+        const shapes = [1, 2, 3].map(s => primitive.makeBox([0, 0, 0], [s, s, s])),
+            meshes = await mesh.batch(shapes, { concurrency: 2 })
+        assert.deepEqual(meshes.map(ret => ret.indices.length), [36, 36, 36])
+
+        const received = [ ],
+            count = await mesh.batch(shapes, { memoryBudget: 1, onMesh: (ret, idx) => received.push(idx) })
+        assert.equal(count, 3)
+        assert.deepEqual(received.sort(), [0, 1, 2])
+
+        const { shape } = bool.generalFuse([primitive.makeBox([0, 0, 0], [2, 1, 1]), primitive.makeBox([1, 0, 0], [3, 1, 1])]),
+            parts = await mesh.batch(shape.find(Shape.types.SOLID), { concurrency: 3 })
+        assert.ok(parts.every(item => item.indices.length >= 36))
+    })
+    it('mesh.batch progress', async () => {
+        const shapes = [1, 2, 3, 4].map(r => primitive.makeSphere([0, 0, 0], r)),
+            fractions = [ ]
+        await mesh.batch(shapes, { deflection: 0.01, concurrency: 2, onProgress: f => fractions.push(f) })
+        assert.ok(fractions.length > 0)
+        assert.ok(fractions.every(f => f >= 0 && f <= 1))
+        assert.ok(fractions[fractions.length - 1] > 0.999)
+
+        // parallel synchronous calls report once the workers return
+        const synced = [ ]
+        mesh.instances(builder.makeCompound(shapes), { onProgress: f => synced.push(f) })
+        assert.ok(synced[synced.length - 1] > 0.999)
+    })
+    it('mesh.batch timeout', async () => {
+        // fine enough that the budget runs out after the first few shapes
+        const shapes = Array.from({ length: 64 }, (_, i) => primitive.makeSphere([i * 3, 0, 0], 1)),
+            received = [ ],
+            start = Date.now()
+        await assert.rejects(mesh.batch(shapes, {
+            deflection: 1e-4, concurrency: 1, timeoutMs: 200,
+            onMesh: (ret, idx) => received.push(idx),
+        }), /timed out/)
+        assert.ok(received.length < shapes.length)
+        assert.ok(Date.now() - start < 10000)
+    })
+    it('mesh.exportGlb', () => {
+        const shapes = [1, 2].map(s => primitive.makeBox([0, 0, 0], [s, s, s])),
+            buf = mesh.exportGlb(shapes),
+            json = JSON.parse(buf.slice(20, 20 + buf.readUInt32LE(12)).toString())
+        assert.equal(buf.readUInt32LE(0), 0x46546C67)
+        assert.equal(buf.readUInt32LE(8), buf.length)
+        assert.equal(json.meshes.length, 2)
+        assert.deepEqual(json.accessors[0].max, [1, 1, 1])
+
+        const chunks = [ ],
+            size = mesh.exportStl(shapes, chunk => chunks.push(chunk))
+        assert.equal(size, 84 + 24 * 50)
+        assert.equal(Buffer.concat(chunks).readUInt32LE(80), 24)
+        if (process.platform === 'linux') {
+            assert.throws(() => mesh.exportStl(shapes, '/dev/full'))
+        }
+    })
+    it('mesh.instances', () => {
+        const comp = primitive.makeBoxes(new Float64Array([0, 0, 0, 1, 1, 1, 1, 1, 1, 3, 3, 3]), { compound: true }),
+            ret = mesh.instances(comp)
+        assert.equal(ret.prototypes.length, 2)
+        assert.deepEqual(Array.from(ret.instances), [0, 1])
+        assert.deepEqual(Array.from(ret.transforms.slice(0, 16)), [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1])
+        assert.equal(ret.prototypes[1].indices.length, 36)
+
+        // a located copy of the same solid is drawn with the first prototype and the offset
+        const box = primitive.makeBox([0, 0, 0], [1, 1, 1]),
+            copies = mesh.instances(builder.makeCompound([box, box.moved([5, 0, 0])]))
+        assert.equal(copies.prototypes.length, 1)
+        assert.deepEqual(Array.from(copies.instances), [0, 0])
+        assert.deepEqual(Array.from(copies.transforms.slice(16, 32)), [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 5, 0, 0, 1])
+        assert.ok(copies.prototypes[0].positions.every(v => v >= 0 && v <= 1))
+
+        // bodies of a general fuse share faces, and are meshed one at a time
+        const fused = bool.generalFuse([primitive.makeBox([0, 0, 0], [2, 1, 1]), primitive.makeBox([1, 0, 0], [3, 1, 1])]),
+            parts = mesh.instances(fused.shape)
+        assert.equal(parts.prototypes.length, 3)
+        assert.ok(parts.prototypes.every(item => item.indices.length >= 36))
+    })
+    it('mesh.meshlets', () => {
+        const input = mesh.create(bool.fuse([primitive.makeBox([0, 0, 0], [1, 1, 1])], [primitive.makeSphere([1, 1, 1], 0.5)]), { deflection: 0.01 }),
+            ret = mesh.meshlets(input, { maxVerts: 32, maxTris: 32 }),
+            count = ret.meshlets.length / 4
+        assert.equal(ret.bounds.length, count * 8)
+        // every input triangle ends up in exactly one cluster of its own face group
+        const remaining = { }
+        for (let t = 0; t < input.indices.length; t += 3) {
+            const key = Array.from(input.indices.slice(t, t + 3)).join() + '/' + input.groups[t]
+            remaining[key] = (remaining[key] || 0) + 1
+        }
+        for (let i = 0; i < count; i ++) {
+            const [vertOffset, vertCount, triOffset, triCount] = ret.meshlets.slice(i * 4, i * 4 + 4)
+            assert.ok(vertCount <= 32 && triCount <= 32)
+            for (let t = triOffset; t < triOffset + triCount * 3; t += 3) {
+                const local = Array.from(ret.triangles.slice(t, t + 3))
+                assert.ok(local.every(v => v < vertCount))
+                const key = local.map(v => ret.vertices[vertOffset + v]).join() + '/' + ret.groups[i]
+                assert.ok(remaining[key] > 0, `unexpected triangle ${key}`)
+                remaining[key] --
+            }
+        }
+        assert.ok(Object.values(remaining).every(n => n === 0))
+    })
+    it('mesh.loadObj', () => {
+        const obj = ['v 0 0 0', 'v 1 0 0', 'v 1 1 0', 'v 0 1 0', 'v 0 0 1', 'v 1 0 1', 'v 1 1 1', 'v 0 1 1',
+                'g bottom', 'f 1 4 3 2', 'g top', 'f 5 6 7 8', 'g sides', 'f 1 2 6 5', 'f 2 3 7 6', 'f 3 4 8 7', 'f 4 1 5 8'].join('\n'),
+            ret = mesh.loadObj(Buffer.from(obj), { toShape: true })
+        assert.deepEqual(ret.names, ['bottom', 'top', 'sides'])
+        assert.equal(ret.indices.length, 36)
+        assert.equal(ret.groups[35], 2)
+        assert.equal(ret.shape.type, Shape.types.SOLID)
+        assert.ok(Math.abs(ret.shape.getVolumeProps().mass - 1) < 1e-6)
+
+        // a collinear triangle on an edge gets no face and leaves the solid closed
+        const flat = mesh.loadObj(Buffer.from(obj + '\nv 0.5 0 0\nf 1 9 2'), { toShape: true })
+        assert.equal(flat.indices.length, 39)
+        assert.equal(flat.shape.type, Shape.types.SOLID)
+    })
+    it('mesh.loadObj in chunks', () => {
+        // a grid sheet of rows written one after another, faces refer back to the previous row
+        // with negative indices, which cross the chunk boundaries
+        const n = 120, rows = [ ], positive = [ ]
+        for (let j = 0; j <= n; j ++) {
+            const row = [`g ${j % 2 ? 'odd' : 'even'}`]
+            for (let i = 0; i <= n; i ++) {
+                row.push(`v ${i} ${j} 0`)
+            }
+            rows.push(...row)
+            positive.push(...row)
+            for (let i = 0; j > 0 && i < n; i ++) {
+                const a = -(2 * (n + 1) - i), b = a + 1, c = -(n + 1 - i) + 1, d = c - 1,
+                    base = (j + 1) * (n + 1) + 1
+                rows.push(`f ${a} ${b} ${c} ${d}`)
+                positive.push(`f ${base + a} ${base + b} ${base + c} ${base + d}`)
+            }
+        }
+        const buf = Buffer.from(rows.join('\n'))
+        assert.ok(buf.length > 4 * 65536)
+        const ret = mesh.loadObj(buf),
+            expected = mesh.loadObj(Buffer.from(positive.join('\n')))
+        assert.equal(ret.positions.length, (n + 1) * (n + 1) * 3)
+        assert.equal(ret.indices.length, n * n * 6)
+        assert.deepEqual(ret.names, ['odd', 'even'])
+        assert.deepEqual(Array.from(ret.indices), Array.from(expected.indices))
+        assert.deepEqual(Array.from(ret.groups), Array.from(expected.groups))
+        assert.ok(ret.indices.every(v => v < (n + 1) * (n + 1)))
+        // every triangle of the sheet faces +z
+        for (let t = 0; t < ret.indices.length; t += 3) {
+            const [p, q, r] = Array.from(ret.indices.slice(t, t + 3)).map(v => ret.positions.slice(v * 3, v * 3 + 2))
+            assert.ok((q[0] - p[0]) * (r[1] - p[1]) - (q[1] - p[1]) * (r[0] - p[0]) > 0)
+        }
+    })
+    it('mesh.topo adjacency', () => {
+        const b = primitive.makeBox([0, 0, 0], [1.1, 1.1, 1.1]),
+            { faceEdges, edgeFaces, edgeVerts, verts } = mesh.topo(b).adjacency
+        assert.equal(faceEdges.offsets.length, 7)
+        assert.equal(faceEdges.indices.length, 24)
+        assert.equal(edgeFaces.offsets.length, 13)
+        assert.ok(edgeFaces.offsets.every((v, i) => v === i * 2))
+        assert.equal(edgeVerts.indices.length, 24)
+        assert.equal(verts.length, 24)
+    })
+    it('mesh.topo with faces', () => {
+        const b = primitive.makeBox([0, 0, 0], [1.1, 1.1, 1.1]),
+            ret = mesh.topo(b, { faces: [1, 4] })
+        assert.deepEqual(ret.faces.map(face => face.index), [1, 4])
+        assert.equal(ret.geom.indices.length, 12)
+    })
     it('mesh.topo', () => {
         const b = primitive.makeBox([0, 0, 0], [1.1, 1.1, 1.1]),
             ret = mesh.topo(b)